@@ -0,0 +1,242 @@
+/**
+ * SECTION 15.9: INTRUSIVE LISTS
+ * --- THEORY PART ---
+ * [1] THE PROBLEM: Link (15.7) owns its value and is made with 'new'. An
+ * object that must sit in two lists needs two Links, and every insert is
+ * a trip to the free store.
+ * [2] INTRUSIVE: Turn it inside out. The OBJECT carries the prev/succ
+ * pointers (a "hook"), and the list just threads through objects that
+ * already exist. The list never allocates and never deletes.
+ * [3] SEVERAL LISTS: An object can carry one hook per list it belongs to.
+ * A tag type tells the hooks apart: List_hook<By_pantheon>, List_hook<By_age>.
+ * [4] O(1) EVERYTHING: Given an object we know its neighbours, so unlinking
+ * it is 4 pointer assignments (no find!), and moving a whole range
+ * [first:last) into another list ("splice") is 6.
+ * [5] SENTINEL: The list holds one dummy hook; the chain is circular through
+ * it, so there are no nullptr special cases in insert/erase.
+ */
+
+#include <iostream>
+#include <string>
+#include <list>
+#include <vector>
+#include <random>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 15.9.1 THE HOOK
+//------------------------------------------------------------------------------
+
+struct Default_tag { };
+
+template<typename Tag = Default_tag>
+struct List_hook {
+    List_hook* prev = nullptr;
+    List_hook* succ = nullptr;
+
+    bool is_linked() const { return succ != nullptr; }
+
+    // Remove this object from whatever list it is in: O(1), no list needed
+    void unlink() {
+        if (!is_linked()) return;
+        prev->succ = succ;
+        succ->prev = prev;
+        prev = succ = nullptr;
+    }
+
+    List_hook() = default;
+    List_hook(const List_hook&) { }              // A copy is not in any list
+    List_hook& operator=(const List_hook&) { return *this; }
+    ~List_hook() { unlink(); }                   // Never leave a dangling neighbour
+};
+
+//------------------------------------------------------------------------------
+// 15.9.2 THE LIST
+//------------------------------------------------------------------------------
+
+template<typename T, typename Tag = Default_tag>
+class Intrusive_list {
+    using Hook = List_hook<Tag>;
+    Hook head;   // Sentinel: head.succ is the first element, head.prev the last
+
+    static T& obj(Hook* h) { return static_cast<T&>(*h); }
+    static Hook* hook(T& x) { return static_cast<Hook*>(&x); }
+
+    // Link the chain [first:last] (inclusive) in before p
+    static void link_before(Hook* p, Hook* first, Hook* last) {
+        first->prev = p->prev;
+        last->succ = p;
+        p->prev->succ = first;
+        p->prev = last;
+    }
+
+public:
+    class iterator {
+        Hook* curr;
+    public:
+        explicit iterator(Hook* p) : curr{p} { }
+        T& operator*() const { return obj(curr); }
+        T* operator->() const { return &obj(curr); }
+        iterator& operator++() { curr = curr->succ; return *this; }
+        iterator& operator--() { curr = curr->prev; return *this; }
+        bool operator==(const iterator& b) const { return curr == b.curr; }
+        bool operator!=(const iterator& b) const { return curr != b.curr; }
+        Hook* node() const { return curr; }
+    };
+
+    Intrusive_list() { head.prev = head.succ = &head; }
+    Intrusive_list(const Intrusive_list&) = delete;
+    Intrusive_list& operator=(const Intrusive_list&) = delete;
+    ~Intrusive_list() { clear(); }
+
+    iterator begin() { return iterator{head.succ}; }
+    iterator end() { return iterator{&head}; }
+    bool empty() const { return head.succ == &head; }
+
+    // Objects must not already be in a list of this Tag
+    iterator insert(iterator pos, T& x) {
+        Hook* h = hook(x);
+        link_before(pos.node(), h, h);
+        return iterator{h};
+    }
+    void push_back(T& x) { insert(end(), x); }
+    void push_front(T& x) { insert(begin(), x); }
+
+    // Unlink x; return the element after it. The object itself lives on.
+    iterator erase(T& x) {
+        Hook* next = hook(x)->succ;
+        hook(x)->unlink();
+        return iterator{next};
+    }
+
+    // Unlink everything (objects are not destroyed: we don't own them)
+    void clear() {
+        while (!empty()) head.succ->unlink();
+    }
+
+    // Move x (from whatever list it is in) to before pos: O(1)
+    void splice(iterator pos, T& x) {
+        Hook* h = hook(x);
+        if (h == pos.node()) return;
+        h->unlink();
+        link_before(pos.node(), h, h);
+    }
+
+    // Move [first:last) from any list to before pos: O(1).
+    // pos must not be inside [first:last).
+    void splice_range(iterator pos, iterator first, iterator last) {
+        if (first == last) return;
+        Hook* f = first.node();
+        Hook* l = last.node()->prev;   // Last element actually moved
+        f->prev->succ = last.node();   // Close the gap in the source
+        last.node()->prev = f->prev;
+        link_before(pos.node(), f, l);
+    }
+};
+
+//------------------------------------------------------------------------------
+// 15.9.3 GODS AND PANTHEONS, INTRUSIVELY
+//------------------------------------------------------------------------------
+
+struct By_pantheon { };   // Tags naming the two lists a God can be in
+struct By_fame { };
+
+struct God : List_hook<By_pantheon>, List_hook<By_fame> {
+    string name;
+    explicit God(const string& n) : name{n} { }
+};
+
+template<typename L>
+void print_all(L& lst) {
+    cout << "{ ";
+    for (auto p = lst.begin(); p != lst.end(); ++p) {
+        if (p != lst.begin()) cout << ", ";
+        cout << p->name;
+    }
+    cout << " }";
+}
+
+void list_demo() {
+    // The objects live here; the lists only link them
+    God thor{"Thor"}, odin{"Odin"}, zeus{"Zeus"}, freja{"Freja"};
+    God hera{"Hera"}, athena{"Athena"}, poseidon{"Poseidon"};
+
+    Intrusive_list<God, By_pantheon> norse_gods;
+    Intrusive_list<God, By_pantheon> greek_gods;
+    Intrusive_list<God, By_fame> famous;
+
+    for (God* g : {&freja, &zeus, &odin, &thor}) norse_gods.push_back(*g);
+    for (God* g : {&poseidon, &athena, &hera}) greek_gods.push_back(*g);
+    famous.push_back(zeus);   // Zeus is in two lists, no extra nodes
+    famous.push_back(thor);
+
+    // Moving Zeus: no find, no erase + insert, just O(1) splice
+    greek_gods.splice(greek_gods.begin(), zeus);
+
+    cout << "Norse Gods: "; print_all(norse_gods); cout << "\n";
+    cout << "Greek Gods: "; print_all(greek_gods); cout << "\n";
+    cout << "Famous:     "; print_all(famous); cout << "\n";
+
+    // Moving a whole range is O(1) too, however long it is
+    Intrusive_list<God, By_pantheon> visitors;
+    visitors.splice_range(visitors.end(), ++norse_gods.begin(), norse_gods.end());
+    cout << "Norse Gods: "; print_all(norse_gods); cout << "\n";
+    cout << "Visitors:   "; print_all(visitors); cout << "\n";
+}
+
+//------------------------------------------------------------------------------
+// 15.9.4 BENCHMARK: CHURN VS STD::LIST
+//------------------------------------------------------------------------------
+
+struct Item : List_hook<> {
+    int id;
+    explicit Item(int i) : id{i} { }
+};
+
+void churn_benchmark() {
+    const int n = 100'000;
+    const int moves = 2'000'000;
+    mt19937 rng{42};
+    uniform_int_distribution<int> pick{0, n - 1};
+
+    // Intrusive: objects stay put; moving between lists is pointer work only
+    vector<Item> items;
+    items.reserve(n);
+    for (int i = 0; i < n; ++i) items.emplace_back(i);
+    Intrusive_list<Item> lists[2];
+    for (Item& x : items) lists[x.id % 2].push_back(x);
+
+    auto t0 = steady_clock::now();
+    for (int i = 0; i < moves; ++i) {
+        Item& x = items[pick(rng)];
+        lists[i % 2].splice(lists[i % 2].end(), x);
+    }
+    auto t1 = steady_clock::now();
+
+    // std::list: remember each element's iterator; a move is erase + push_back
+    list<int> slists[2];
+    vector<pair<int, list<int>::iterator>> where(n);
+    for (int i = 0; i < n; ++i) where[i] = {i % 2, slists[i % 2].insert(slists[i % 2].end(), i)};
+
+    rng.seed(42);
+    auto t2 = steady_clock::now();
+    for (int i = 0; i < moves; ++i) {
+        int id = pick(rng);
+        slists[where[id].first].erase(where[id].second);
+        where[id] = {i % 2, slists[i % 2].insert(slists[i % 2].end(), id)};
+    }
+    auto t3 = steady_clock::now();
+
+    // Intrusive_list::clear runs before items are destroyed (declared later)
+    cout << "Intrusive_list splice churn: " << duration_cast<microseconds>(t1 - t0).count() << "us\n";
+    cout << "std::list erase+insert churn: " << duration_cast<microseconds>(t3 - t2).count() << "us\n";
+}
+
+int main() {
+    list_demo();
+    churn_benchmark();
+    return 0;
+}
@@ -16,8 +16,11 @@
 #include <vector>
 #include <memory>
 #include <algorithm> // For std::swap
+#include <string>
+#include <chrono>
 
 using namespace std;
+using namespace std::chrono;
 
 //------------------------------------------------------------------------------
 // 18.4.4 RAII FOR VECTOR: THE REPRESENTATION STRATEGY
@@ -58,6 +61,13 @@ public:
         for (int i = 0; i < r.sz; ++i) construct_at(&r.elem[i], T{});
     }
 
+    // If uninitialized_copy throws, it destroys what it built and r frees the memory
+    Vector(const Vector& arg) : r{arg.r.alloc, arg.r.sz} {
+        uninitialized_copy(arg.r.elem, arg.r.elem + arg.r.sz, r.elem);
+    }
+
+    ~Vector() { destroy(r.elem, r.elem + r.sz); } // r then frees the memory
+
     //--------------------------------------------------------------------------
     // THE STRONG GUARANTEE: COPY ASSIGNMENT
     //--------------------------------------------------------------------------
@@ -65,12 +75,36 @@ public:
     // Strategy: Copy-and-Swap. 
     // If the copy fails, 'this' is untouched (Strong Guarantee).
     // If it succeeds, we swap pointers (No-throw operation).
+    //
+    // Copy-and-swap allocates even when we already have enough space. If
+    // copying a T can't throw, copying in place can't fail half-way either,
+    // so it gives the same Strong Guarantee without the allocation.
     Vector& operator=(const Vector& arg) {
+        if (this == &arg) return *this;
+
+        if constexpr (is_nothrow_copy_constructible_v<T> && is_nothrow_copy_assignable_v<T>) {
+            if (arg.r.sz <= r.space) {
+                int common = min(r.sz, arg.r.sz);
+                copy(arg.r.elem, arg.r.elem + common, r.elem);              // Assign over live elements
+                uninitialized_copy(arg.r.elem + common, arg.r.elem + arg.r.sz,
+                                   r.elem + common);                        // Construct into spare space
+                destroy(r.elem + arg.r.sz, r.elem + r.sz);                  // Drop any surplus
+                r.sz = arg.r.sz;
+                return *this;
+            }
+        }
+
         Vector temp{arg};     // 1. Create a temporary copy
-        swap(r, temp.r);      // 2. Swap our guts with the copy
+        swap_rep(temp);       // 2. Swap our guts with the copy
         return *this;         // 3. 'temp' goes out of scope, carrying our OLD memory to its death
     }
 
+    void swap_rep(Vector& v) noexcept {
+        swap(r.elem, v.r.elem);
+        swap(r.sz, v.r.sz);
+        swap(r.space, v.r.space);
+    }
+
     //--------------------------------------------------------------------------
     // THE STRONG GUARANTEE: RESERVE
     //--------------------------------------------------------------------------
@@ -93,7 +127,11 @@ public:
         // r.sz stays the same
     }
 
+    T& operator[](int n) { return r.elem[n]; }
+    const T& operator[](int n) const { return r.elem[n]; }
+
     int size() const { return r.sz; }
+    int capacity() const { return r.space; }
 };
 
 //------------------------------------------------------------------------------
@@ -117,11 +155,44 @@ void safe_raii(int x) {
     // ... any exception ...// SAFE: p's destructor runs
 }
 
+//------------------------------------------------------------------------------
+// BENCHMARK: REPEATED SAME-SIZE ASSIGNMENT
+//------------------------------------------------------------------------------
+
+void assignment_benchmark() {
+    const int n = 100000;
+    const int reps = 200;
+    Vector<int> src(n);
+    for (int i = 0; i < n; ++i) src[i] = i;
+    Vector<int> dst(n);
+
+    auto t0 = steady_clock::now();
+    for (int i = 0; i < reps; ++i) {
+        Vector<int> temp{src};  // What operator= always did before
+        dst.swap_rep(temp);
+    }
+    auto t1 = steady_clock::now();
+    for (int i = 0; i < reps; ++i) dst = src;   // Reuses dst's space
+    auto t2 = steady_clock::now();
+
+    cout << "copy-and-swap: " << duration_cast<microseconds>(t1 - t0).count() / reps
+         << "us per assignment\n";
+    cout << "in place:      " << duration_cast<microseconds>(t2 - t1).count() / reps
+         << "us per assignment\n";
+}
+
 int main() {
     Vector<int> v1(5);
     Vector<int> v2(10);
     
-    v1 = v2; // Uses Copy-and-Swap for Strong Guarantee
+    v1 = v2; // int can't throw: v1 must grow, so this still uses Copy-and-Swap
+    v2 = v1; // ...but this one reuses v2's space in place
+
+    Vector<string> s1(3);
+    Vector<string> s2(3);
+    s1 = s2; // string copies may throw: always Copy-and-Swap
+
+    assignment_benchmark();
     
     return 0;
 }
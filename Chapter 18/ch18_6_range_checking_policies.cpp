@@ -0,0 +1,214 @@
+/**
+ * SECTION 18.6: RANGE-CHECKING POLICIES
+ * --- THEORY PART ---
+ * [1] THE PROBLEM: Checked_vector (18.3.2) sends every [] through .at(). The
+ * branch inside the loop stops the compiler from vectorizing hot loops.
+ * [2] POLICY CLASSES: Make "how do we check?" a template parameter. The
+ * choice is made at compile time, so the unused checks cost nothing.
+ * - No_check:     plain elem[n], exactly what Vector::operator[] does.
+ * - Assert_check: assert() in debug builds, nothing when NDEBUG is defined.
+ * - Throw_check:  throws out_of_range, the 18.3 behaviour.
+ * [3] BUILD MACRO: PPP_CHECK_POLICY picks the default policy, so the same
+ * code is safe in test builds and free in production builds.
+ * [4] CHECK ONCE PER LOOP: A Checked_range validates [first:last) once when
+ * it is made; iterating it is then as fast as a raw pointer loop.
+ */
+
+#include <iostream>
+#include <vector>
+#include <stdexcept> // For std::out_of_range
+#include <cassert>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 18.6.1 THE CHECK POLICIES
+//------------------------------------------------------------------------------
+
+struct No_check {
+    static void check(int, int) { }
+};
+
+struct Assert_check {
+    static void check(int n, int sz) {
+        assert(0 <= n && n < sz && "range error");
+        (void)n; (void)sz; // Unused when NDEBUG is defined
+    }
+};
+
+struct Throw_check {
+    static void check(int n, int sz) {
+        if (n < 0 || sz <= n) throw out_of_range{"Vector::at()"};
+    }
+};
+
+// Build with -DPPP_CHECK_POLICY=0 (none), 1 (assert) or 2 (throw)
+#ifndef PPP_CHECK_POLICY
+#define PPP_CHECK_POLICY 2
+#endif
+
+#if PPP_CHECK_POLICY == 0
+using Default_check = No_check;
+#elif PPP_CHECK_POLICY == 1
+using Default_check = Assert_check;
+#else
+using Default_check = Throw_check;
+#endif
+
+//------------------------------------------------------------------------------
+// 18.6.2 CHECKED RANGES: VALIDATE ONCE, THEN RUN UNCHECKED
+//------------------------------------------------------------------------------
+
+/* * A view of the elements [first:last). The bounds are checked against the
+ * owner's size in the constructor; the loop body then uses raw pointers.
+ */
+template<typename T, typename Check = Default_check>
+class Checked_range {
+    T* first;
+    T* last;
+public:
+    Checked_range(T* elem, int sz, int b, int e) : first{elem + b}, last{elem + e} {
+        if (b == e) return;   // An empty range is always fine
+        Check::check(b, sz);
+        Check::check(e - 1, sz);
+        Check::check(b, e);   // b must come before e
+    }
+
+    T* begin() const { return first; }
+    T* end() const { return last; }
+    int size() const { return static_cast<int>(last - first); }
+};
+
+//------------------------------------------------------------------------------
+// 18.6.3 VECTOR WITH A CHECK POLICY
+//------------------------------------------------------------------------------
+
+template<typename T, typename Check = Default_check>
+class Vector {
+    int sz;
+    T* elem;
+    int space;
+public:
+    explicit Vector(int s) : sz{s}, elem{new T[s]}, space{s} {
+        for (int i = 0; i < sz; ++i) elem[i] = T{};
+    }
+
+    Vector(const Vector&) = delete;
+    Vector& operator=(const Vector&) = delete;
+
+    ~Vector() { delete[] elem; }
+
+    // Unchecked access is unchanged
+    T& operator[](int n) { return elem[n]; }
+    const T& operator[](int n) const { return elem[n]; }
+
+    // at() checks according to the policy
+    T& at(int n) { Check::check(n, sz); return elem[n]; }
+    const T& at(int n) const { Check::check(n, sz); return elem[n]; }
+
+    // Check [b:e) once, hand back a fast view
+    Checked_range<T, Check> range(int b, int e) { return {elem, sz, b, e}; }
+    Checked_range<const T, Check> range(int b, int e) const { return {elem, sz, b, e}; }
+
+    int size() const { return sz; }
+
+    T* begin() { return elem; }
+    T* end() { return elem + sz; }
+};
+
+//------------------------------------------------------------------------------
+// 18.6.4 CHECKED_VECTOR WITH A POLICY
+//------------------------------------------------------------------------------
+
+template<typename T, typename Check = Default_check>
+struct Checked_vector : public std::vector<T> {
+    using std::vector<T>::vector; // Inherit all constructors
+    using size_type = typename std::vector<T>::size_type;
+
+    T& operator[](size_type i) {
+        Check::check(static_cast<int>(i), static_cast<int>(this->size()));
+        return std::vector<T>::operator[](i);
+    }
+
+    const T& operator[](size_type i) const {
+        Check::check(static_cast<int>(i), static_cast<int>(this->size()));
+        return std::vector<T>::operator[](i);
+    }
+
+    Checked_range<T, Check> range(int b, int e) {
+        return {this->data(), static_cast<int>(this->size()), b, e};
+    }
+};
+
+//------------------------------------------------------------------------------
+// 18.6.5 BENCHMARK: CHECKED VS UNCHECKED LOOPS
+//------------------------------------------------------------------------------
+
+template<typename F>
+void time_it(const string& label, F f) {
+    auto t0 = steady_clock::now();
+    long long sum = f();
+    auto t1 = steady_clock::now();
+    cout << label << ": " << duration_cast<microseconds>(t1 - t0).count()
+         << "us (sum " << sum << ")\n";
+}
+
+void benchmark() {
+    const int n = 10'000'000;
+    const int reps = 10;
+    Vector<int, Throw_check> v(n);
+    for (int i = 0; i < n; ++i) v[i] = i % 7;
+
+    time_it("at() every element (Throw_check)", [&] {
+        long long s = 0;
+        for (int r = 0; r < reps; ++r)
+            for (int i = 0; i < v.size(); ++i) s += v.at(i);
+        return s;
+    });
+
+    time_it("operator[] (unchecked)", [&] {
+        long long s = 0;
+        for (int r = 0; r < reps; ++r)
+            for (int i = 0; i < v.size(); ++i) s += v[i];
+        return s;
+    });
+
+    time_it("range() checked once per loop", [&] {
+        long long s = 0;
+        for (int r = 0; r < reps; ++r)
+            for (int x : v.range(0, v.size())) s += x;
+        return s;
+    });
+}
+
+int main() {
+    Vector<int> v(100);
+
+    try {
+        v.at(200) = 7; // Throws under the default (Throw_check) policy
+    } catch (const out_of_range& e) {
+        cerr << "Caught range error: " << e.what() << endl;
+    }
+
+    try {
+        for (int& x : v.range(50, 150)) x = 1; // Caught before the loop starts
+    } catch (const out_of_range&) {
+        cout << "Checked_range rejected [50:150) up front\n";
+    }
+
+    Checked_vector<int> cv = {1, 2, 3};
+    try {
+        int x = cv[10];
+        cout << x;
+    } catch (...) {
+        cout << "Checked_vector caught an out-of-bounds access!" << endl;
+    }
+
+    Checked_vector<int, No_check> fast = {1, 2, 3}; // Production: no cost
+    cout << "Unchecked Checked_vector: " << fast[1] << "\n";
+
+    benchmark();
+    return 0;
+}
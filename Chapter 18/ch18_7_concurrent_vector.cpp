@@ -0,0 +1,193 @@
+/**
+ * SECTION 18.7: A CONCURRENT APPEND VECTOR
+ * --- THEORY PART ---
+ * [1] THE PROBLEM: Vector::push_back may reserve(), which moves every element
+ * to new memory. Another thread reading at that moment reads freed memory, so
+ * the usual fix is a mutex around every push_back. All threads then queue up.
+ * [2] SEGMENTED STORAGE: Never move elements. Keep a small table of segments
+ * whose sizes double (8, 16, 32, ...). Growing means adding a segment, so an
+ * element's address never changes once it has been constructed.
+ * [3] ATOMIC RESERVATION: Each push_back claims a unique index with a
+ * compare-exchange on the size, which first checks that the index fits, so a
+ * full vector throws without counting a slot it never fills. No two threads
+ * ever write the same slot. A new segment is installed with a
+ * compare-exchange too; so that threads almost never race to allocate one,
+ * the thread that claims the first slot of segment k allocates segment k+1.
+ * [4] PUBLICATION: A slot is readable only after its "ready" flag is set with
+ * release ordering; readers test it with acquire ordering.
+ */
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <new>
+#include <bit>       // For std::bit_width
+#include <chrono>
+#include <stdexcept>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 18.7.1 THE SEGMENT TABLE
+//------------------------------------------------------------------------------
+
+template<typename T>
+class Concurrent_vector {
+    static constexpr size_t first_seg = 8;  // Size of segment 0
+    static constexpr int max_seg = 40;      // 8 * (2^40 - 1) elements: plenty
+
+    struct Slot {
+        alignas(T) unsigned char buf[sizeof(T)];
+        atomic<bool> ready{false};
+        T* get() { return launder(reinterpret_cast<T*>(buf)); }
+    };
+
+    atomic<Slot*> seg[max_seg] = {};
+    atomic<size_t> sz{0};   // Number of claimed slots (some may still be under construction)
+
+    static size_t seg_size(int k) { return first_seg << k; }
+
+    // Map a global index to (segment, offset) with a single bit_width
+    static int seg_of(size_t i) { return bit_width(i + first_seg) - bit_width(first_seg); }
+    static size_t offset_of(size_t i, int k) { return i + first_seg - seg_size(k); }
+
+    // Return segment k, allocating it if no thread has done so yet. Lock-free:
+    // if threads race, each allocates a segment and all but the winner delete
+    // theirs. Pre-allocation (see emplace_back()) makes that rare
+    Slot* segment(int k) {
+        Slot* s = seg[k].load(memory_order_acquire);
+        if (s) return s;
+        Slot* fresh = new Slot[seg_size(k)];
+        if (seg[k].compare_exchange_strong(s, fresh, memory_order_acq_rel))
+            return fresh;
+        delete[] fresh;   // Another thread won the race; use its segment
+        return s;
+    }
+
+public:
+    Concurrent_vector() { segment(0); }
+    Concurrent_vector(const Concurrent_vector&) = delete;
+    Concurrent_vector& operator=(const Concurrent_vector&) = delete;
+
+    ~Concurrent_vector() {
+        size_t n = sz.load();
+        for (int k = 0; k < max_seg; ++k) {
+            Slot* s = seg[k].load();
+            if (!s) continue;
+            for (size_t j = 0; j < seg_size(k) && seg_size(k) - first_seg + j < n; ++j)
+                if (s[j].ready.load()) destroy_at(s[j].get());
+            delete[] s;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // 18.7.2 LOCK-FREE APPEND
+    //--------------------------------------------------------------------------
+
+    template<typename... Args>
+    size_t emplace_back(Args&&... args) {
+        size_t i = sz.load(memory_order_relaxed);
+        do {                                               // Claim slot i
+            if (seg_of(i) >= max_seg) throw length_error{"Concurrent_vector too large"};
+        } while (!sz.compare_exchange_weak(i, i + 1, memory_order_relaxed));
+        int k = seg_of(i);
+        size_t off = offset_of(i, k);
+        // First into segment k: get segment k+1 ready long before anyone needs it
+        if (off == 0 && k + 1 < max_seg) segment(k + 1);
+        Slot& s = segment(k)[off];
+        construct_at(s.get(), std::forward<Args>(args)...);
+        s.ready.store(true, memory_order_release);        // Publish it
+        return i;
+    }
+
+    size_t push_back(const T& val) { return emplace_back(val); }
+    size_t push_back(T&& val) { return emplace_back(std::move(val)); }
+
+    //--------------------------------------------------------------------------
+    // 18.7.3 CONCURRENT READS OF PUBLISHED ELEMENTS
+    //--------------------------------------------------------------------------
+
+    // Number of claimed slots; an element below size() may not be ready yet
+    size_t size() const { return sz.load(memory_order_acquire); }
+
+    // nullptr if element i has not been published yet
+    const T* try_get(size_t i) const {
+        if (i >= size()) return nullptr;
+        int k = seg_of(i);
+        Slot* s = seg[k].load(memory_order_acquire);
+        if (!s) return nullptr;
+        Slot& slot = s[offset_of(i, k)];
+        return slot.ready.load(memory_order_acquire) ? slot.get() : nullptr;
+    }
+
+    // Only use once the writers are known to be done
+    const T& operator[](size_t i) const {
+        int k = seg_of(i);
+        return *seg[k].load(memory_order_acquire)[offset_of(i, k)].get();
+    }
+};
+
+//------------------------------------------------------------------------------
+// 18.7.4 BENCHMARK: MUTEX + VECTOR VS CONCURRENT_VECTOR, 1 TO 64 THREADS
+//------------------------------------------------------------------------------
+
+template<typename F>
+long long time_threads(int nthreads, F f) {
+    vector<thread> ts;
+    auto t0 = steady_clock::now();
+    for (int t = 0; t < nthreads; ++t) ts.emplace_back(f, t);
+    for (auto& t : ts) t.join();
+    return duration_cast<microseconds>(steady_clock::now() - t0).count();
+}
+
+void scaling_benchmark() {
+    const int total = 4'000'000;
+    cout << "threads  mutex+vector(us)  Concurrent_vector(us)\n";
+
+    for (int nthreads = 1; nthreads <= 64; nthreads *= 2) {
+        const int per_thread = total / nthreads;
+
+        vector<int> v;
+        mutex m;
+        long long d1 = time_threads(nthreads, [&](int t) {
+            for (int i = 0; i < per_thread; ++i) {
+                lock_guard<mutex> lck{m};
+                v.push_back(t * per_thread + i);
+            }
+        });
+
+        Concurrent_vector<int> cv;
+        long long d2 = time_threads(nthreads, [&](int t) {
+            for (int i = 0; i < per_thread; ++i) cv.push_back(t * per_thread + i);
+        });
+
+        if (v.size() != cv.size()) cerr << "size mismatch!\n";
+        cout << nthreads << "\t " << d1 << "\t\t   " << d2 << "\n";
+    }
+}
+
+int main() {
+    Concurrent_vector<string> names;
+
+    // Writers append while a reader scans what has been published so far
+    thread w1{[&] { for (int i = 0; i < 1000; ++i) names.emplace_back("a" + to_string(i)); }};
+    thread w2{[&] { for (int i = 0; i < 1000; ++i) names.emplace_back("b" + to_string(i)); }};
+    thread r{[&] {
+        size_t seen = 0;
+        while (seen < 2000)
+            for (seen = 0; seen < names.size() && names.try_get(seen); ++seen) { }
+    }};
+    w1.join();
+    w2.join();
+    r.join();
+
+    cout << "Appended " << names.size() << " names; first is " << names[0] << "\n";
+
+    scaling_benchmark();
+    return 0;
+}
@@ -0,0 +1,207 @@
+/**
+ * SECTION 18.8: COPY-ON-WRITE VECTOR
+ * --- THEORY PART ---
+ * [1] THE PROBLEM: Vector's copy constructor (17.9) always deep-copies, and
+ * copy-and-swap (18.4) always builds a fresh temporary. Handing a large
+ * read-mostly vector to many readers pays a full copy per reader.
+ * [2] SHARED REPRESENTATION: Like shared_ptr (18.5.3), many Cow_vectors can
+ * point to one representation with a reference count. Copying is then O(1):
+ * bump the count and share the pointer.
+ * [3] DETACH ON FIRST WRITE: Before any mutation, a Cow_vector that shares its
+ * representation makes a private copy ("detaches"). Readers never notice.
+ * [4] ATOMIC COUNTS: The count is atomic so snapshots can be copied and
+ * dropped from different threads.
+ * [5] FINDING ACCIDENTAL WRITES: Every detach is counted. A non-const [] on a
+ * snapshot detaches even if you only meant to read, so a high count shows
+ * where a const& was forgotten.
+ */
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <utility>    // For move, swap
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 18.8.1 THE SHARED REPRESENTATION
+//------------------------------------------------------------------------------
+
+template<typename T>
+struct Cow_rep {
+    atomic<int> refs{1};  // Number of Cow_vectors sharing this
+    int sz;
+    T* elem;
+    int space;
+
+    explicit Cow_rep(int s) : sz{s}, elem{new T[s]}, space{s} { }
+
+    Cow_rep(const Cow_rep& arg, int newalloc)
+        : sz{arg.sz}, elem{new T[newalloc]}, space{newalloc} {
+        copy(arg.elem, arg.elem + arg.sz, elem);
+    }
+
+    ~Cow_rep() { delete[] elem; }
+};
+
+// Global detach counter; read it in tests or print it at exit
+atomic<long> cow_detaches{0};
+
+//------------------------------------------------------------------------------
+// 18.8.2 COW_VECTOR
+//------------------------------------------------------------------------------
+
+template<typename T>
+class Cow_vector {
+    Cow_rep<T>* r;
+
+    // What a moved-from Cow_vector shares: empty, and never deleted, because
+    // it holds a reference to itself. Moving therefore allocates nothing
+    static inline Cow_rep<T> empty_rep{0};
+
+    static Cow_rep<T>* empty() noexcept {
+        empty_rep.refs.fetch_add(1, memory_order_relaxed);
+        return &empty_rep;
+    }
+
+    void release() {
+        if (r->refs.fetch_sub(1, memory_order_acq_rel) == 1) delete r;
+    }
+
+    // Make sure we are the only owner and have room for at least 'space' elements
+    void detach(int space) {
+        if (r->refs.load(memory_order_acquire) == 1 && space <= r->space) return;
+        if (r->refs.load(memory_order_acquire) != 1 && r != &empty_rep)   // Writing to a moved-from vector is fine
+            cow_detaches.fetch_add(1, memory_order_relaxed);
+        Cow_rep<T>* p = new Cow_rep<T>{*r, max(space, r->space)};
+        release();
+        r = p;
+    }
+    void detach() { detach(r->space); }
+
+public:
+    Cow_vector() : r{new Cow_rep<T>{0}} { }
+    explicit Cow_vector(int s) : r{new Cow_rep<T>{s}} {
+        for (int i = 0; i < s; ++i) r->elem[i] = T{};
+    }
+
+    ~Cow_vector() { release(); }
+
+    //--- COPY: O(1), SHARES THE REPRESENTATION ---
+
+    Cow_vector(const Cow_vector& arg) : r{arg.r} {
+        r->refs.fetch_add(1, memory_order_relaxed);
+    }
+
+    Cow_vector& operator=(const Cow_vector& arg) {
+        arg.r->refs.fetch_add(1, memory_order_relaxed); // First, so self-assignment is safe
+        release();
+        r = arg.r;
+        return *this;
+    }
+
+    //--- MOVE: STEAL THE POINTER, LEAVE A VALID EMPTY VECTOR BEHIND ---
+
+    Cow_vector(Cow_vector&& a) noexcept : r{a.r} { a.r = empty(); }
+
+    Cow_vector& operator=(Cow_vector&& a) noexcept {
+        swap(r, a.r);   // a releases our old representation when it goes away
+        return *this;
+    }
+
+    //--- READS: NEVER DETACH ---
+
+    const T& operator[](int n) const { return r->elem[n]; }
+    const T* begin() const { return r->elem; }
+    const T* end() const { return r->elem + r->sz; }
+    int size() const { return r->sz; }
+    int capacity() const { return r->space; }
+    bool shared() const { return r->refs.load(memory_order_relaxed) > 1; }
+
+    //--- WRITES: DETACH FIRST ---
+
+    T& operator[](int n) { detach(); return r->elem[n]; }
+    T* begin() { detach(); return r->elem; }
+    T* end() { detach(); return r->elem + r->sz; }
+
+    void reserve(int newalloc) {
+        if (newalloc > r->space) detach(newalloc);
+    }
+
+    void push_back(const T& val) {
+        if (r->space == 0) detach(8);
+        else if (r->sz == r->space) detach(2 * r->space);
+        else detach();
+        r->elem[r->sz] = val;
+        ++r->sz;
+    }
+};
+
+//------------------------------------------------------------------------------
+// 18.8.3 BENCHMARK: DEEP-COPY SNAPSHOTS VS COW SNAPSHOTS
+//------------------------------------------------------------------------------
+
+// The same reader for both kinds of snapshot
+template<typename V>
+double read_sum(const V& v) {
+    double s = 0;
+    for (double x : v) s += x;   // const: a Cow_vector never detaches
+    return s;
+}
+
+void snapshot_benchmark() {
+    const int n = 1'000'000;
+    const int readers = 8;
+
+    vector<double> big(n, 1.0);
+    Cow_vector<double> cbig;
+    for (int i = 0; i < n; ++i) cbig.push_back(1.0);
+
+    auto t0 = steady_clock::now();
+    {
+        vector<thread> ts;
+        for (int i = 0; i < readers; ++i)
+            ts.emplace_back([snap = big] { volatile double s = read_sum(snap); (void)s; });
+        for (auto& t : ts) t.join();
+    }
+    auto t1 = steady_clock::now();
+    {
+        vector<thread> ts;
+        for (int i = 0; i < readers; ++i)
+            ts.emplace_back([snap = cbig] { volatile double s = read_sum(snap); (void)s; });
+        for (auto& t : ts) t.join();
+    }
+    auto t2 = steady_clock::now();
+
+    cout << readers << " deep-copy snapshots: " << duration_cast<microseconds>(t1 - t0).count() << "us\n";
+    cout << readers << " COW snapshots:       " << duration_cast<microseconds>(t2 - t1).count() << "us\n";
+}
+
+int main() {
+    Cow_vector<int> a;
+    for (int i = 0; i < 5; ++i) a.push_back(i);
+
+    Cow_vector<int> b = a;          // O(1): a and b share storage
+    cout << "shared after copy: " << b.shared() << "\n";
+
+    const Cow_vector<int>& cb = b;
+    cout << "read b[2] = " << cb[2] << ", detaches so far: " << cow_detaches << "\n";
+
+    b[2] = 42;                      // First write: b detaches
+    cout << "after write a[2] = " << static_cast<const Cow_vector<int>&>(a)[2]
+         << ", b[2] = " << cb[2] << "\n";
+    cout << "detaches: " << cow_detaches << "\n";
+
+    Cow_vector<int> c = move(b);    // b is left empty, but still usable
+    b.push_back(7);
+    cout << "after move: c.size() = " << c.size() << ", b.size() = " << b.size() << "\n";
+
+    long before = cow_detaches;
+    snapshot_benchmark();
+    cout << "detaches during benchmark: " << cow_detaches - before << " (0 means no accidental writes)\n";
+    return 0;
+}
@@ -0,0 +1,241 @@
+/**
+ * SECTION 18.9: A PACKED BIT VECTOR
+ * --- THEORY PART ---
+ * [1] THE PROBLEM: A Vector<char> (18.1) of flags spends a whole byte (8 bits)
+ * on every yes/no answer. Millions of flags waste megabytes and cache.
+ * [2] PACKING: Store 64 flags in each uint64_t "word." Bit i lives in word
+ * i/64 at position i%64.
+ * [3] WORD-AT-A-TIME: and/or/xor/not work on 64 flags per instruction, and
+ * <bit> gives us popcount (count the 1s) and countr_zero (find the lowest 1)
+ * which compile to single machine instructions on modern CPUs.
+ * [4] RANK AND SELECT:
+ * - rank(i):   how many 1s are there before position i?
+ * - select(k): where is the k-th 1 (counting from 0)?
+ * A small directory of running counts (one per 512 bits) makes both fast.
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <bit>        // For std::popcount, std::countr_zero
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 18.9.0 THE BYTE-PER-FLAG BASELINE (Vector from 18.1)
+//------------------------------------------------------------------------------
+
+template<typename T>
+class Vector {
+    int sz;
+    T* elem;
+    int space;
+public:
+    explicit Vector(int s) : sz{s}, elem{new T[s]}, space{s} {
+        for (int i = 0; i < sz; ++i) elem[i] = T{};
+    }
+    Vector(const Vector&) = delete;
+    Vector& operator=(const Vector&) = delete;
+    ~Vector() { delete[] elem; }
+
+    T& operator[](int n) { return elem[n]; }
+    const T& operator[](int n) const { return elem[n]; }
+    int size() const { return sz; }
+};
+
+//------------------------------------------------------------------------------
+// 18.9.1 BIT_VECTOR
+//------------------------------------------------------------------------------
+
+class Bit_vector {
+    using Word = uint64_t;
+    static constexpr int bits = 64;
+    static constexpr int block_words = 8;   // Rank directory entry per 512 bits
+
+    int sz;                  // Number of bits
+    vector<Word> w;          // ceil(sz/64) words; bits past sz are always 0
+    vector<int> rank_dir;    // rank_dir[b] = number of 1s in blocks [0:b)
+    bool rank_valid = false; // Any modification invalidates the directory
+
+    // Keep the unused high bits of the last word zero so count() stays exact
+    void trim() {
+        if (sz % bits) w.back() &= (Word{1} << (sz % bits)) - 1;
+        rank_valid = false;
+    }
+
+    void build_rank() {
+        int nblocks = static_cast<int>(w.size() + block_words - 1) / block_words;
+        rank_dir.assign(nblocks + 1, 0);
+        for (int b = 0; b < nblocks; ++b) {
+            int c = 0;
+            for (int j = b * block_words; j < min<int>((b + 1) * block_words, w.size()); ++j)
+                c += popcount(w[j]);
+            rank_dir[b + 1] = rank_dir[b] + c;
+        }
+        rank_valid = true;
+    }
+
+public:
+    static constexpr int npos = -1;
+
+    explicit Bit_vector(int n, bool val = false)
+        : sz{n}, w((n + bits - 1) / bits, val ? ~Word{0} : Word{0}) {
+        if (n < 0) throw length_error{"Bit_vector: negative size"};
+        if (!w.empty()) trim();
+    }
+
+    int size() const { return sz; }
+    int words() const { return static_cast<int>(w.size()); }
+
+    //--- SINGLE-BIT ACCESS ---
+
+    bool test(int i) const { return (w[i / bits] >> (i % bits)) & 1; }
+    bool operator[](int i) const { return test(i); }
+
+    void set(int i, bool val = true) {
+        Word mask = Word{1} << (i % bits);
+        if (val) w[i / bits] |= mask;
+        else w[i / bits] &= ~mask;
+        rank_valid = false;
+    }
+    void reset(int i) { set(i, false); }
+
+    //--- WORD-AT-A-TIME BULK OPERATIONS ---
+
+    Bit_vector& operator&=(const Bit_vector& b) {
+        if (sz != b.sz) throw invalid_argument{"Bit_vector: size mismatch"};
+        for (size_t j = 0; j < w.size(); ++j) w[j] &= b.w[j];
+        rank_valid = false;
+        return *this;
+    }
+
+    Bit_vector& operator|=(const Bit_vector& b) {
+        if (sz != b.sz) throw invalid_argument{"Bit_vector: size mismatch"};
+        for (size_t j = 0; j < w.size(); ++j) w[j] |= b.w[j];
+        rank_valid = false;
+        return *this;
+    }
+
+    Bit_vector& operator^=(const Bit_vector& b) {
+        if (sz != b.sz) throw invalid_argument{"Bit_vector: size mismatch"};
+        for (size_t j = 0; j < w.size(); ++j) w[j] ^= b.w[j];
+        rank_valid = false;
+        return *this;
+    }
+
+    Bit_vector& flip() {
+        for (Word& x : w) x = ~x;
+        if (!w.empty()) trim();
+        return *this;
+    }
+
+    //--- COUNTING AND SEARCHING ---
+
+    int count() const {
+        int c = 0;
+        for (Word x : w) c += popcount(x);
+        return c;
+    }
+
+    // Position of the first 1 at or after 'from', or npos
+    int find_next(int from) const {
+        if (from >= sz) return npos;
+        size_t j = from / bits;
+        Word x = w[j] & (~Word{0} << (from % bits));  // Ignore bits before 'from'
+        while (x == 0) {
+            if (++j == w.size()) return npos;
+            x = w[j];
+        }
+        return static_cast<int>(j * bits + countr_zero(x));
+    }
+
+    int find_first() const { return find_next(0); }
+
+    // Number of 1s in [0:i)
+    int rank(int i) {
+        if (!rank_valid) build_rank();
+        int j = i / bits;
+        int c = rank_dir[j / block_words];
+        for (int k = (j / block_words) * block_words; k < j; ++k) c += popcount(w[k]);
+        if (i % bits) c += popcount(w[j] & ((Word{1} << (i % bits)) - 1));
+        return c;
+    }
+
+    // Position of the k-th 1 (k counts from 0), or npos
+    int select(int k) {
+        if (!rank_valid) build_rank();
+        if (k < 0 || k >= rank_dir.back()) return npos;
+        // Last block whose running count is <= k
+        int b = static_cast<int>(upper_bound(rank_dir.begin(), rank_dir.end(), k) - rank_dir.begin()) - 1;
+        int left = k - rank_dir[b];
+        for (size_t j = b * block_words; j < w.size(); ++j) {
+            int c = popcount(w[j]);
+            if (left < c) {
+                Word x = w[j];
+                for (int t = 0; t < left; ++t) x &= x - 1;  // Clear the lowest 'left' 1s
+                return static_cast<int>(j * bits + countr_zero(x));
+            }
+            left -= c;
+        }
+        return npos;
+    }
+};
+
+Bit_vector operator&(Bit_vector a, const Bit_vector& b) { return a &= b; }
+Bit_vector operator|(Bit_vector a, const Bit_vector& b) { return a |= b; }
+Bit_vector operator^(Bit_vector a, const Bit_vector& b) { return a ^= b; }
+Bit_vector operator~(Bit_vector a) { return a.flip(); }
+
+//------------------------------------------------------------------------------
+// 18.9.2 BENCHMARK: MEMORY AND SCAN SPEED
+//------------------------------------------------------------------------------
+
+void benchmark() {
+    const int n = 50'000'000;
+    Vector<char> bytes(n);
+    Bit_vector packed(n);
+    for (int i = 0; i < n; i += 7) { bytes[i] = 1; packed.set(i); }
+
+    cout << "Memory: Vector<char> " << n / (1024 * 1024) << " MB, Bit_vector "
+         << packed.words() * sizeof(uint64_t) / (1024 * 1024) << " MB\n";
+
+    auto t0 = steady_clock::now();
+    int c1 = 0;
+    for (int i = 0; i < bytes.size(); ++i) c1 += bytes[i];
+    auto t1 = steady_clock::now();
+    int c2 = packed.count();
+    auto t2 = steady_clock::now();
+    int c3 = 0;
+    for (int i = packed.find_first(); i != Bit_vector::npos; i = packed.find_next(i + 1)) ++c3;
+    auto t3 = steady_clock::now();
+
+    cout << "count, byte per flag:    " << duration_cast<microseconds>(t1 - t0).count() << "us (" << c1 << ")\n";
+    cout << "count(), popcount:       " << duration_cast<microseconds>(t2 - t1).count() << "us (" << c2 << ")\n";
+    cout << "find_first/find_next:    " << duration_cast<microseconds>(t3 - t2).count() << "us (" << c3 << ")\n";
+}
+
+int main() {
+    Bit_vector a(100);
+    Bit_vector b(100);
+    for (int i = 0; i < 100; i += 2) a.set(i);   // Even numbers
+    for (int i = 0; i < 100; i += 3) b.set(i);   // Multiples of 3
+
+    Bit_vector both = a & b;                     // Multiples of 6
+    cout << "multiples of 6 below 100: " << both.count() << "\n";
+    cout << "odd numbers below 100: " << (~a).count() << "\n";
+
+    cout << "multiples of 6:";
+    for (int i = both.find_first(); i != Bit_vector::npos; i = both.find_next(i + 1))
+        cout << ' ' << i;
+    cout << "\n";
+
+    cout << "rank(50) = " << both.rank(50) << ", select(3) = " << both.select(3) << "\n";
+
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,238 @@
+/**
+ * SECTION 19.10: SORTING A LINKED LIST IN PLACE
+ * --- THE CONCEPT ---
+ * std::sort needs random-access iterators, so the obvious way to sort a Link
+ * chain is: copy the values into a vector, sort, copy back. That doubles the
+ * memory. Merge sort only ever walks forward, so it suits lists perfectly:
+ * 1. Relinking: we never move a value; we just re-hook succ pointers.
+ * 2. Bottom-up: merge runs of 1, then 2, then 4, ... No recursion and no
+ * copy of the data; the extra space is a fixed table of 64 pointers.
+ * 3. Stable: when two values compare equal, the one from the left run goes
+ * first, so equal elements keep their original order.
+ * 4. prev pointers are ignored while sorting and repaired in one final pass.
+ * 5. Parallel: cut a long chain into pieces, sort each piece on its own
+ * thread, then merge the sorted pieces.
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.10.1 THE LINK (as in 19.3)
+//------------------------------------------------------------------------------
+
+template<typename T>
+struct Link {
+    T val;
+    Link* prev;
+    Link* succ;
+    Link(const T& v, Link* p = nullptr, Link* s = nullptr)
+        : val{v}, prev{p}, succ{s} { }
+};
+
+//------------------------------------------------------------------------------
+// 19.10.2 THE BUILDING BLOCKS
+//------------------------------------------------------------------------------
+
+// Cut the chain after n links; return the head of the rest (or nullptr)
+template<typename T>
+Link<T>* split_after(Link<T>* p, long n) {
+    for (long i = 1; p && i < n; ++i) p = p->succ;
+    if (!p) return nullptr;
+    Link<T>* rest = p->succ;
+    p->succ = nullptr;
+    return rest;
+}
+
+// Merge two sorted chains (succ only); return the head. Stable: ties go to a.
+// tail points to the pointer the next link goes into: first head, then the
+// succ of the last link taken (no dummy Link, so T needs no default constructor)
+template<typename T, typename Cmp>
+Link<T>* merge(Link<T>* a, Link<T>* b, Cmp& cmp) {
+    Link<T>* head = nullptr;
+    Link<T>** tail = &head;
+    while (a && b) {
+        if (cmp(b->val, a->val)) { *tail = b; b = b->succ; }
+        else { *tail = a; a = a->succ; }
+        tail = &(*tail)->succ;
+    }
+    *tail = a ? a : b;
+    return head;
+}
+
+// Rebuild the prev pointers after sorting by succ
+template<typename T>
+void fix_prev(Link<T>* head) {
+    Link<T>* prev = nullptr;
+    for (Link<T>* p = head; p; p = p->succ) {
+        p->prev = prev;
+        prev = p;
+    }
+}
+
+//------------------------------------------------------------------------------
+// 19.10.3 BOTTOM-UP MERGE SORT
+//------------------------------------------------------------------------------
+
+/* * Like counting in binary: run[k] is either empty or a sorted run of 2^k
+ * links. Each new link is a run of 1; merging it in "carries" upward. The
+ * table has a fixed 64 entries whatever the length of the list: O(1) space.
+ * Runs in higher slots hold earlier links, so they are always merged as the
+ * LEFT argument; that keeps the sort stable.
+ */
+template<typename T, typename Cmp = less<T>>
+Link<T>* sort_list(Link<T>* head, Cmp cmp = Cmp{}) {
+    if (!head || !head->succ) return head;
+
+    Link<T>* run[64] = {};
+    while (head) {
+        Link<T>* carry = head;
+        head = head->succ;
+        carry->succ = nullptr;
+        int k = 0;
+        for (; run[k]; ++k) {
+            carry = merge(run[k], carry, cmp);
+            run[k] = nullptr;
+        }
+        run[k] = carry;
+    }
+
+    Link<T>* result = nullptr;
+    for (Link<T>* r : run)
+        if (r) result = merge(r, result, cmp);
+    fix_prev(result);
+    return result;
+}
+
+//------------------------------------------------------------------------------
+// 19.10.4 PARALLEL SORT FOR VERY LONG LISTS
+//------------------------------------------------------------------------------
+
+template<typename T, typename Cmp = less<T>>
+Link<T>* parallel_sort_list(Link<T>* head, Cmp cmp = Cmp{},
+                            int nthreads = thread::hardware_concurrency()) {
+    long n = 0;
+    for (Link<T>* p = head; p; p = p->succ) ++n;
+    nthreads = max(1, nthreads);
+    if (nthreads == 1 || n < 100'000) return sort_list(head, cmp);
+
+    // Cut into nthreads chains of about n/nthreads links each
+    vector<Link<T>*> piece;
+    for (Link<T>* p = head; p; ) {
+        piece.push_back(p);
+        p = split_after(p, (n + nthreads - 1) / nthreads);
+    }
+
+    {
+        vector<thread> ts;
+        for (auto& p : piece)
+            ts.emplace_back([&p, cmp] { p = sort_list(p, cmp); });
+        for (auto& t : ts) t.join();
+    }
+
+    // Merge the sorted pieces pairwise, in parallel too; keep left before
+    // right so the result stays stable
+    while (piece.size() > 1) {
+        vector<Link<T>*> next((piece.size() + 1) / 2);
+        vector<thread> ts;
+        for (size_t i = 0; i + 1 < piece.size(); i += 2)
+            ts.emplace_back([&, i, cmp]() mutable { next[i / 2] = merge(piece[i], piece[i + 1], cmp); });
+        if (piece.size() % 2) next.back() = piece.back();
+        for (auto& t : ts) t.join();
+        piece = move(next);
+    }
+    fix_prev(piece[0]);
+    return piece[0];
+}
+
+//------------------------------------------------------------------------------
+// 19.10.5 HELPERS AND BENCHMARK
+//------------------------------------------------------------------------------
+
+template<typename T>
+Link<T>* make_chain(const vector<T>& v) {
+    Link<T>* head = nullptr;
+    for (auto p = v.rbegin(); p != v.rend(); ++p) {
+        head = new Link<T>{*p, nullptr, head};
+        if (head->succ) head->succ->prev = head;
+    }
+    return head;
+}
+
+template<typename T>
+void delete_chain(Link<T>* p) {
+    while (p) {
+        Link<T>* next = p->succ;
+        delete p;
+        p = next;
+    }
+}
+
+// The old way: copy out, sort, copy back (twice the memory)
+template<typename T, typename Cmp = less<T>>
+void copy_sort_rebuild(Link<T>* head, Cmp cmp = Cmp{}) {
+    vector<T> v;
+    for (Link<T>* p = head; p; p = p->succ) v.push_back(p->val);
+    stable_sort(v.begin(), v.end(), cmp);
+    Link<T>* p = head;
+    for (const T& x : v) { p->val = x; p = p->succ; }
+}
+
+template<typename T>
+bool is_sorted_chain(Link<T>* p) {
+    for (; p && p->succ; p = p->succ)
+        if (p->succ->val < p->val || p->succ->prev != p) return false;
+    return true;
+}
+
+void benchmark() {
+    const int n = 2'000'000;
+    mt19937 rng{5};
+    vector<int> data(n);
+    for (int& x : data) x = rng();
+
+    Link<int>* a = make_chain(data);
+    Link<int>* b = make_chain(data);
+    Link<int>* c = make_chain(data);
+
+    auto t0 = steady_clock::now();
+    copy_sort_rebuild(a);
+    auto t1 = steady_clock::now();
+    b = sort_list(b);
+    auto t2 = steady_clock::now();
+    c = parallel_sort_list(c, less<int>{}, 8);
+    auto t3 = steady_clock::now();
+
+    cout << "copy-sort-rebuild:   " << duration_cast<milliseconds>(t1 - t0).count() << "ms\n";
+    cout << "sort_list:           " << duration_cast<milliseconds>(t2 - t1).count() << "ms\n";
+    cout << "parallel_sort_list:  " << duration_cast<milliseconds>(t3 - t2).count() << "ms\n";
+    cout << "all sorted: " << (is_sorted_chain(a) && is_sorted_chain(b) && is_sorted_chain(c)) << "\n";
+
+    delete_chain(a);
+    delete_chain(b);
+    delete_chain(c);
+}
+
+int main() {
+    // Stability: sort gods by name length; equal lengths keep their order
+    vector<string> gods = {"Thor", "Odin", "Freja", "Zeus", "Hera", "Athena", "Ares"};
+    Link<string>* head = make_chain(gods);
+    head = sort_list(head, [](const string& a, const string& b) { return a.size() < b.size(); });
+
+    cout << "By length:";
+    for (Link<string>* p = head; p; p = p->succ) cout << ' ' << p->val;
+    cout << "\n";
+    delete_chain(head);
+
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,313 @@
+/**
+ * SECTION 19.11: A PIECE-TABLE DOCUMENT
+ * --- THE ARCHITECTURE ---
+ * The Document of 19.5 is a list<vector<char>>: loading a file allocates one
+ * list node and one vector per line, and a paste that spans lines means
+ * splitting vectors by hand. A PIECE TABLE never copies existing text:
+ * [1] Original buffer: the file as loaded, in ONE string. Never modified.
+ * [2] Add buffer: everything ever typed or pasted, appended at the end.
+ * Also never modified, only grown.
+ * [3] Pieces: the document is a sequence of pieces, each "n characters of
+ * buffer B starting at s." Inserting splits one piece and adds one; deleting
+ * trims or drops pieces. The text itself never moves.
+ * [4] Balanced tree: the pieces are kept in a treap (a randomized balanced
+ * binary tree) where each node knows the total length of its subtree, so
+ * finding "character 1234567" and splitting there are O(log pieces).
+ * [5] Text_iterator: still walks the document one character at a time, so
+ * match() and find_txt() from 19.5 work unchanged.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.11.1 THE PIECE TREE
+//------------------------------------------------------------------------------
+
+struct Piece_node {
+    const string* buf;    // &original or &add
+    size_t start;         // Offset in buf
+    size_t len;           // Characters in this piece
+    unsigned prio;        // Treap priority: parents have higher priority
+    size_t total;         // Characters in this whole subtree
+    int count;            // Pieces in this whole subtree
+    Piece_node* left = nullptr;
+    Piece_node* right = nullptr;
+    Piece_node* parent = nullptr;
+
+    Piece_node(const string* b, size_t s, size_t n, unsigned p)
+        : buf{b}, start{s}, len{n}, prio{p}, total{n}, count{1} { }
+};
+
+size_t total(Piece_node* t) { return t ? t->total : 0; }
+int count(Piece_node* t) { return t ? t->count : 0; }
+
+// Recompute t's totals from its children and make them point back to t
+void update(Piece_node* t) {
+    t->total = total(t->left) + t->len + total(t->right);
+    t->count = count(t->left) + 1 + count(t->right);
+    if (t->left) t->left->parent = t;
+    if (t->right) t->right->parent = t;
+}
+
+// Join two trees: every character of a comes before every character of b
+Piece_node* merge(Piece_node* a, Piece_node* b) {
+    if (!a) return b;
+    if (!b) return a;
+    if (a->prio > b->prio) {
+        a->right = merge(a->right, b);
+        update(a);
+        return a;
+    }
+    b->left = merge(a, b->left);
+    update(b);
+    return b;
+}
+
+//------------------------------------------------------------------------------
+// 19.11.2 THE DOCUMENT
+//------------------------------------------------------------------------------
+
+class Document {
+    string original;   // The file, as loaded
+    string add;        // Everything inserted since
+    Piece_node* root = nullptr;
+    mt19937 rng{2024};
+
+    Piece_node* new_piece(const string* b, size_t s, size_t n) {
+        return new Piece_node{b, s, n, static_cast<unsigned>(rng())};
+    }
+
+    // Split t so that the first tree holds exactly the first 'pos' characters.
+    // A piece straddling pos is cut into two pieces (no text is copied).
+    pair<Piece_node*, Piece_node*> split(Piece_node* t, size_t pos) {
+        if (!t) return {nullptr, nullptr};
+        size_t lt = total(t->left);
+        if (pos <= lt) {
+            auto [a, b] = split(t->left, pos);
+            t->left = b;
+            update(t);
+            return {a, t};
+        }
+        if (pos >= lt + t->len) {
+            auto [a, b] = split(t->right, pos - lt - t->len);
+            t->right = a;
+            update(t);
+            return {t, b};
+        }
+        // pos is inside this piece: keep the front here, put the back in a new
+        // node. Giving it t's priority keeps the treap's heap order intact.
+        size_t front = pos - lt;
+        Piece_node* back = new Piece_node{t->buf, t->start + front, t->len - front, t->prio};
+        t->len = front;
+        back->right = t->right;
+        t->right = nullptr;
+        update(back);
+        update(t);
+        return {t, back};
+    }
+
+    void set_root(Piece_node* t) {
+        root = t;
+        if (root) root->parent = nullptr;
+    }
+
+    static void destroy(Piece_node* t) {
+        if (!t) return;
+        destroy(t->left);
+        destroy(t->right);
+        delete t;
+    }
+
+public:
+    Document() = default;
+    explicit Document(string text) : original{move(text)} {
+        if (!original.empty()) set_root(new_piece(&original, 0, original.size()));
+    }
+    Document(const Document&) = delete;
+    Document& operator=(const Document&) = delete;
+    ~Document() { destroy(root); }
+
+    size_t size() const { return total(root); }
+    int pieces() const { return count(root); }
+
+    // Insert s before character pos: O(log pieces), existing text untouched
+    void insert(size_t pos, const string& s) {
+        if (s.empty()) return;
+        pos = min(pos, size());
+        size_t start = add.size();
+        add += s;
+        auto [a, b] = split(root, pos);
+        set_root(merge(merge(a, new_piece(&add, start, s.size())), b));
+    }
+
+    // Erase n characters starting at pos: O(log pieces) plus the pieces dropped
+    void erase(size_t pos, size_t n) {
+        auto [a, rest] = split(root, pos);
+        auto [gone, b] = split(rest, n);
+        destroy(gone);
+        set_root(merge(a, b));
+    }
+
+    // Copy out the whole text (for printing and testing)
+    string str() const {
+        string s;
+        s.reserve(size());
+        for (auto p = begin(); p != end(); ++p) s += *p;
+        return s;
+    }
+
+    //--------------------------------------------------------------------------
+    // 19.11.3 THE TEXT ITERATOR
+    //--------------------------------------------------------------------------
+
+    class Text_iterator {
+        const Piece_node* node;   // nullptr means end()
+        size_t off;               // Character within node's piece
+
+        static const Piece_node* leftmost(const Piece_node* t) {
+            while (t && t->left) t = t->left;
+            return t;
+        }
+
+        // In-order successor, using the parent pointers
+        static const Piece_node* successor(const Piece_node* t) {
+            if (t->right) return leftmost(t->right);
+            while (t->parent && t->parent->right == t) t = t->parent;
+            return t->parent;
+        }
+
+    public:
+        Text_iterator(const Piece_node* n = nullptr, size_t o = 0) : node{n}, off{o} {
+            while (node && node->len == 0) node = successor(node);   // Skip empty pieces
+        }
+
+        static Text_iterator first(const Piece_node* root) { return Text_iterator{leftmost(root)}; }
+
+        char operator*() const { return (*node->buf)[node->start + off]; }
+
+        // Move within the piece; hop to the next piece at its end
+        Text_iterator& operator++() {
+            if (++off == node->len) {
+                node = successor(node);
+                off = 0;
+                while (node && node->len == 0) node = successor(node);
+            }
+            return *this;
+        }
+
+        bool operator==(const Text_iterator& other) const {
+            return node == other.node && off == other.off;
+        }
+        bool operator!=(const Text_iterator& other) const { return !(*this == other); }
+    };
+
+    Text_iterator begin() const { return Text_iterator::first(root); }
+    Text_iterator end() const { return Text_iterator{}; }
+};
+
+using Text_iterator = Document::Text_iterator;
+
+//------------------------------------------------------------------------------
+// 19.11.4 SEARCHING: THE 19.5 CODE, UNCHANGED
+//------------------------------------------------------------------------------
+
+bool match(Text_iterator p, Text_iterator last, const string& s) {
+    for (char c : s) {
+        if (p == last || *p != c) return false;
+        ++p;
+    }
+    return true;
+}
+
+Text_iterator find_txt(Text_iterator first, Text_iterator last, const string& s) {
+    if (s.empty()) return last;
+    char first_char = s[0];
+
+    for (auto p = first; p != last; ++p) {
+        if (*p == first_char && match(p, last, s)) {
+            return p;
+        }
+    }
+    return last;
+}
+
+//------------------------------------------------------------------------------
+// 19.11.5 BENCHMARK: LOAD, MEMORY AND EDITS VS list<Line>
+//------------------------------------------------------------------------------
+
+using Line = vector<char>;
+
+/* * 'file' stands in for a large log (the target is 500MB; 50MB keeps the
+ * demo quick). list<Line> memory is estimated as list node + vector header
+ * + capacity per line; the piece table's as the two buffers plus tree nodes.
+ */
+void benchmark() {
+    string file;
+    const size_t target = 50'000'000;
+    for (int i = 0; file.size() < target; ++i)
+        file += "2024-01-01 12:00:00 INFO request " + to_string(i) + " served in 3ms\n";
+
+    auto t0 = steady_clock::now();
+    list<Line> lines(1);
+    for (char c : file) {
+        lines.back().push_back(c);
+        if (c == '\n') lines.push_back(Line{});
+    }
+    auto t1 = steady_clock::now();
+    Document doc{file};
+    auto t2 = steady_clock::now();
+
+    size_t list_bytes = 0;
+    for (const Line& ln : lines) list_bytes += 2 * sizeof(void*) + sizeof(Line) + ln.capacity();
+    cout << "load: list<Line> " << duration_cast<milliseconds>(t1 - t0).count() << "ms, "
+         << list_bytes / 1'000'000 << "MB; piece table "
+         << duration_cast<milliseconds>(t2 - t1).count() << "ms, "
+         << (file.size() + sizeof(Piece_node)) / 1'000'000 << "MB\n";
+
+    // Random edits: insert a short string at a random place, or delete a few characters
+    const int edits = 100'000;
+    mt19937 rng{9};
+    auto t3 = steady_clock::now();
+    for (int e = 0; e < edits; ++e) {
+        size_t pos = rng() % doc.size();
+        if (e % 2) doc.erase(pos, 5);
+        else doc.insert(pos, "PASTE\nHERE");
+    }
+    auto t4 = steady_clock::now();
+
+    const int list_edits = 100;   // Each one walks O(lines): keep it short
+    for (int e = 0; e < list_edits; ++e) {
+        auto p = lines.begin();
+        advance(p, rng() % lines.size());
+        p->insert(p->begin() + rng() % (p->size() + 1), {'P', 'A', 'S', 'T', 'E'});
+    }
+    auto t5 = steady_clock::now();
+
+    cout << "edit: piece table " << duration<double, micro>(t4 - t3).count() / edits
+         << "us each (" << doc.pieces() << " pieces); list<Line> "
+         << duration<double, micro>(t5 - t4).count() / list_edits << "us each\n";
+}
+
+int main() {
+    Document doc{"Hello, world!\nSecond line\n"};
+    doc.insert(7, "big ");               // "Hello, big world!"
+    doc.erase(0, 5);                     // ", big world!"
+    doc.insert(0, "Goodbye");
+    doc.insert(doc.size(), "secret\n");  // Paste spanning a line end: no splitting vectors
+    cout << doc.str();
+
+    auto p = find_txt(doc.begin(), doc.end(), "secret");
+    if (p != doc.end()) cout << "Found the secret!\n";
+
+    benchmark();
+    return 0;
+}
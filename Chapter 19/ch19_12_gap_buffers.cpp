@@ -0,0 +1,253 @@
+/**
+ * SECTION 19.12: GAP BUFFERS FOR LINES
+ * --- THE ARCHITECTURE ---
+ * In 19.5 a Line is a vector<char>. Typing in the middle of a line inserts
+ * into the vector, which shifts every character after the cursor. On a
+ * several-MB line (minified JSON, say) every keystroke costs O(line length).
+ * [1] THE GAP: keep the free space of the buffer IN THE MIDDLE, at the
+ * cursor, instead of at the end:   "Hello, ____________world!"
+ * [2] Typing fills the gap from the left: O(1). Backspace widens it: O(1).
+ * [3] Moving the cursor moves the gap, copying only the characters between
+ * the old and new cursor positions. Editors edit locally, so that distance
+ * is usually tiny: amortized O(1) per keystroke.
+ * [4] Searching doesn't need the text in one piece: find() searches the
+ * text before the gap and the text after it as two plain spans, and checks
+ * the few positions where a match could straddle the gap. Nothing moves, so
+ * a search doesn't undo the cursor position. When one span really is needed,
+ * contiguous() moves the gap to the end (one O(n) memmove).
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <string>
+#include <string_view>
+#include <span>
+#include <algorithm>
+#include <cstring>    // For memmove
+#include <stdexcept>
+#include <random>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.12.1 THE GAP BUFFER
+//------------------------------------------------------------------------------
+
+class Gap_buffer {
+    vector<char> buf;     // [0:gap_begin) text, [gap_begin:gap_end) gap, [gap_end:) text
+    size_t gap_begin = 0;
+    size_t gap_end = 0;
+
+    size_t gap() const { return gap_end - gap_begin; }
+
+    // Move the gap so that it starts at text position pos
+    void move_gap(size_t pos) {
+        if (pos < gap_begin) {        // Shift [pos:gap_begin) to the right of the gap
+            size_t n = gap_begin - pos;
+            memmove(buf.data() + gap_end - n, buf.data() + pos, n);
+            gap_begin -= n;
+            gap_end -= n;
+        } else if (pos > gap_begin) { // Shift text after the gap to its left
+            size_t n = pos - gap_begin;
+            memmove(buf.data() + gap_begin, buf.data() + gap_end, n);
+            gap_begin += n;
+            gap_end += n;
+        }
+    }
+
+    // A position in the text: 0 to size() (the end)
+    void check(size_t pos) const {
+        if (pos > size()) throw out_of_range{"Gap_buffer: bad position " + to_string(pos)};
+    }
+
+    // Make the gap at least n wide (doubling, as Vector::push_back does)
+    void grow(size_t n) {
+        if (gap() >= n) return;
+        size_t tail = buf.size() - gap_end;
+        size_t newsize = max(2 * buf.size(), buf.size() + n);
+        newsize = max<size_t>(newsize, 16);
+        buf.resize(newsize);
+        memmove(buf.data() + newsize - tail, buf.data() + gap_end, tail);
+        gap_end = newsize - tail;
+    }
+
+public:
+    Gap_buffer() = default;
+    Gap_buffer(string_view s) { insert(0, s); }
+
+    size_t size() const { return buf.size() - gap(); }
+
+    char operator[](size_t i) const { return i < gap_begin ? buf[i] : buf[i + gap()]; }
+
+    // The cursor is wherever the gap is
+    size_t cursor() const { return gap_begin; }
+
+    void insert(size_t pos, char c) {
+        check(pos);
+        grow(1);
+        move_gap(pos);
+        buf[gap_begin++] = c;
+    }
+
+    void insert(size_t pos, string_view s) {
+        check(pos);
+        if (s.empty()) return;   // Nothing to copy (and s.data() may be null)
+        grow(s.size());
+        move_gap(pos);
+        memcpy(buf.data() + gap_begin, s.data(), s.size());
+        gap_begin += s.size();
+    }
+
+    // Erase n characters starting at pos: just widen the gap
+    void erase(size_t pos, size_t n = 1) {
+        check(pos);
+        n = min(n, size() - pos);
+        move_gap(pos);
+        gap_end += n;
+    }
+
+    // The two halves of the text, without moving anything
+    span<const char> before_gap() const { return {buf.data(), gap_begin}; }
+    span<const char> after_gap() const { return {buf.data() + gap_end, buf.size() - gap_end}; }
+
+    // Where s first occurs, or npos. Read-only: the gap stays where it is
+    size_t find(string_view s) const {
+        string_view before{buf.data(), gap_begin};
+        string_view after{buf.data() + gap_end, buf.size() - gap_end};
+        if (s.empty()) return 0;
+        if (size_t p = before.find(s); p != string_view::npos) return p;
+
+        // Matches that start in the last s.size()-1 characters before the gap
+        for (size_t p = gap_begin - min(gap_begin, s.size() - 1); p < gap_begin; ++p) {
+            if (p + s.size() > size()) break;
+            size_t i = 0;
+            while (i < s.size() && (*this)[p + i] == s[i]) ++i;
+            if (i == s.size()) return p;
+        }
+
+        if (size_t p = after.find(s); p != string_view::npos) return gap_begin + p;
+        return string_view::npos;
+    }
+
+    // The whole text as one span: moves the gap to the end first
+    span<const char> contiguous() {
+        move_gap(size());
+        return {buf.data(), size()};
+    }
+
+    string str() const {
+        string s(before_gap().begin(), before_gap().end());
+        s.append(after_gap().begin(), after_gap().end());
+        return s;
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.12.2 THE DOCUMENT, WITH GAP-BUFFER LINES
+//------------------------------------------------------------------------------
+
+using Line = Gap_buffer;
+
+struct Document {
+    list<Line> line;
+    Document() { line.push_back(Line{}); }
+};
+
+// Search each line on both sides of its gap, without moving any gap
+bool find_in_lines(const Document& d, string_view s, int& line_no, size_t& col) {
+    line_no = 0;
+    for (const Line& ln : d.line) {
+        size_t p = ln.find(s);
+        if (p != string_view::npos) { col = p; return true; }
+        ++line_no;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// 19.12.3 BENCHMARK: REPLAYING AN EDIT TRACE ON A HUGE LINE
+//------------------------------------------------------------------------------
+
+struct Edit {
+    size_t pos;
+    bool insert;   // false: backspace
+    char c;
+};
+
+/* * Like a person typing: mostly at the cursor, occasional small cursor
+ * moves, rarely a jump somewhere else in the line.
+ */
+vector<Edit> make_trace(size_t line_len, int n) {
+    mt19937 rng{11};
+    vector<Edit> trace;
+    size_t cursor = line_len / 2;
+    size_t len = line_len;
+    for (int i = 0; i < n; ++i) {
+        int r = rng() % 100;
+        if (r == 0) cursor = rng() % len;                              // Jump
+        else if (r < 10) cursor = min(len, cursor + rng() % 20);       // Arrow keys
+        if (r < 85 || cursor == 0) {
+            trace.push_back({cursor, true, char('a' + rng() % 26)});
+            ++cursor;
+            ++len;
+        } else {
+            trace.push_back({cursor - 1, false, 0});
+            --cursor;
+            --len;
+        }
+    }
+    return trace;
+}
+
+void replay_benchmark() {
+    const size_t line_len = 4'000'000;   // A 4MB minified-JSON line
+    const int edits = 20'000;
+    vector<Edit> trace = make_trace(line_len, edits);
+    string json(line_len, 'x');
+
+    vector<char> v(json.begin(), json.end());
+    auto t0 = steady_clock::now();
+    for (const Edit& e : trace) {
+        if (e.insert) v.insert(v.begin() + e.pos, e.c);
+        else v.erase(v.begin() + e.pos);
+    }
+    auto t1 = steady_clock::now();
+
+    Gap_buffer g{json};
+    auto t2 = steady_clock::now();
+    for (const Edit& e : trace) {
+        if (e.insert) g.insert(e.pos, e.c);
+        else g.erase(e.pos);
+    }
+    auto t3 = steady_clock::now();
+
+    span<const char> text = g.contiguous();
+    bool same = equal(text.begin(), text.end(), v.begin(), v.end());
+    cout << "vector<char>: " << duration<double, micro>(t1 - t0).count() / edits << "us per edit\n";
+    cout << "Gap_buffer:   " << duration<double, micro>(t3 - t2).count() / edits << "us per edit"
+         << " (same text: " << same << ")\n";
+}
+
+int main() {
+    Document doc;
+    Line& ln = doc.line.front();
+    ln.insert(0, "Hello world!");
+    ln.insert(5, ',');          // The gap moves to 5, then fills
+    ln.insert(6, " big");       // Right at the gap: no copying at all
+    ln.erase(0, 1);             // Backspace at the front
+    ln.insert(0, 'J');
+    doc.line.push_back(Line{"a secret line"});
+
+    for (const Line& l : doc.line) cout << l.str() << "\n";
+
+    int n;
+    size_t col;
+    if (find_in_lines(doc, "secret", n, col))
+        cout << "Found the secret on line " << n << " at column " << col << "\n";
+
+    replay_benchmark();
+    return 0;
+}
@@ -0,0 +1,256 @@
+/**
+ * SECTION 19.13: FAST TEXT SEARCH
+ * --- THE PROBLEM ---
+ * find_txt() in 19.5 steps a Text_iterator one character at a time and calls
+ * match() at every occurrence of the first character: O(n*m) comparisons,
+ * with a "did we hit the end of the line?" test on every single byte.
+ * --- THE SOLUTION ---
+ * [1] Work on spans: a Line is a vector<char>, i.e. contiguous memory. Search
+ * each line with plain pointers; never use the Text_iterator in the hot loop.
+ * [2] SIMD candidate scan: compare 16 positions at once against BOTH the first
+ * and the last character of the pattern (SSE2). Only positions where both
+ * agree are checked with memcmp; in real text that is rare.
+ * [3] Horspool: without SIMD (or for the last few bytes of a span) use the
+ * Boyer-Moore-Horspool rule: look at the text character under the END of the
+ * pattern and skip ahead by up to m characters at once.
+ * [4] Matches across lines: carry the last m-1 characters of each line into a
+ * small window with the start of the next one, so "end\nstart" is found too.
+ * [5] find_all() returns every match as a (line, column) position.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <string>
+#include <string_view>
+#include <cstring>     // For memcmp
+#include <algorithm>
+#include <chrono>
+
+#if defined(__SSE2__)
+#include <emmintrin.h> // SSE2 intrinsics
+#endif
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.13.1 THE 19.5 DOCUMENT (AND ITS find_txt, FOR COMPARISON)
+//------------------------------------------------------------------------------
+
+using Line = vector<char>;
+
+struct Document {
+    list<Line> line;
+    Document() { line.push_back(Line{}); }   // Always ends with an empty line
+    struct Text_iterator begin();
+    struct Text_iterator end();
+};
+
+struct Text_iterator {
+    list<Line>::iterator ln;
+    Line::iterator pos;
+
+    Text_iterator(list<Line>::iterator ll, Line::iterator pp) : ln{ll}, pos{pp} { }
+
+    char& operator*() { return *pos; }
+
+    Text_iterator& operator++() {
+        ++pos;
+        if (pos == ln->end()) {
+            ++ln;
+            pos = ln->begin();
+        }
+        return *this;
+    }
+
+    bool operator==(const Text_iterator& other) const { return ln == other.ln && pos == other.pos; }
+    bool operator!=(const Text_iterator& other) const { return !(*this == other); }
+};
+
+Text_iterator Document::begin() { return Text_iterator{line.begin(), line.begin()->begin()}; }
+Text_iterator Document::end() {
+    auto last = line.end();
+    --last;
+    return Text_iterator{last, last->end()};
+}
+
+bool match(Text_iterator p, Text_iterator last, const string& s) {
+    for (char c : s) {
+        if (p == last || *p != c) return false;
+        ++p;
+    }
+    return true;
+}
+
+Text_iterator find_txt(Text_iterator first, Text_iterator last, const string& s) {
+    if (s.empty()) return last;
+    char first_char = s[0];
+    for (auto p = first; p != last; ++p)
+        if (*p == first_char && match(p, last, s)) return p;
+    return last;
+}
+
+// Add text, splitting it into lines that keep their '\n' (as typing would)
+void append_text(Document& d, string_view text) {
+    auto last = prev(d.line.end());
+    for (char c : text) {
+        last->push_back(c);
+        if (c == '\n') last = d.line.insert(d.line.end(), Line{});
+    }
+    // Keep exactly one empty line at the end
+    if (!last->empty()) d.line.push_back(Line{});
+}
+
+//------------------------------------------------------------------------------
+// 19.13.2 SEARCHING ONE CONTIGUOUS SPAN
+//------------------------------------------------------------------------------
+
+class Searcher {
+    string pat;
+    size_t shift[256];   // Horspool: how far to move when char c is under the pattern's end
+
+public:
+    explicit Searcher(string_view p) : pat{p} {
+        fill(begin(shift), end(shift), max<size_t>(pat.size(), 1));
+        for (size_t i = 0; i + 1 < pat.size(); ++i)
+            shift[static_cast<unsigned char>(pat[i])] = pat.size() - 1 - i;
+    }
+
+    size_t size() const { return pat.size(); }
+    string_view pattern() const { return pat; }
+
+    // Call f(offset) for every match in [s:s+n) that starts at or after 'from'
+    template<typename F>
+    void scan(const char* s, size_t n, F f, size_t from = 0) const {
+        const size_t m = pat.size();
+        if (m == 0 || n < m) return;
+        size_t i = from;
+
+#if defined(__SSE2__)
+        if (m >= 2) {
+            const __m128i first = _mm_set1_epi8(pat[0]);
+            const __m128i last = _mm_set1_epi8(pat[m - 1]);
+            for (; i + m - 1 + 16 <= n; i += 16) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + m - 1));
+                unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first),
+                                                                _mm_cmpeq_epi8(b, last)));
+                while (mask) {   // Each set bit is a candidate: check the middle
+                    int bit = __builtin_ctz(mask);
+                    if (memcmp(s + i + bit + 1, pat.data() + 1, m - 2) == 0) f(i + bit);
+                    mask &= mask - 1;
+                }
+            }
+        }
+#endif
+        // Horspool for whatever is left (all of it, without SSE2)
+        while (i + m <= n) {
+            unsigned char c = s[i + m - 1];
+            if (c == static_cast<unsigned char>(pat[m - 1]) && memcmp(s + i, pat.data(), m - 1) == 0)
+                f(i);
+            i += shift[c];
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.13.3 SEARCHING THE DOCUMENT, INCLUDING ACROSS LINES
+//------------------------------------------------------------------------------
+
+struct Text_pos {
+    int line;
+    size_t col;
+};
+
+/* * Each line is scanned on its own. Matches that cross a line end are found
+ * in a small window: the last m-1 characters seen so far ("carry") followed
+ * by the first m-1 characters of the new line. A window match is reported
+ * only if it starts in the carry and ends in the new line, so nothing is
+ * reported twice. All matches have length m, so reporting them in the order
+ * they END is also the order they START: f sees them in document order.
+ */
+template<typename F>
+void for_each_match(Document& d, const Searcher& pat, F f) {
+    const size_t m = pat.size();
+    if (m == 0) return;
+    string carry;              // Up to m-1 characters from before this line
+    vector<Text_pos> carry_pos;
+    string window;
+    const char first = pat.pattern()[0];
+
+    int ln = 0;
+    for (const Line& line : d.line) {
+        // 1. Matches crossing into this line (only possible if the carry
+        //    holds the pattern's first character somewhere)
+        if (carry.find(first) != string::npos) {
+            size_t head = min(m - 1, line.size());
+            window.assign(carry);
+            window.append(line.data(), head);
+            pat.scan(window.data(), window.size(), [&](size_t i) {
+                if (i < carry.size() && i + m > carry.size()) f(carry_pos[i]);
+            });
+        }
+
+        // 2. Matches wholly inside this line
+        pat.scan(line.data(), line.size(), [&](size_t i) { f(Text_pos{ln, i}); });
+
+        // 3. Keep the last m-1 characters for the next line
+        size_t tail = line.size() > m - 1 ? line.size() - (m - 1) : 0;
+        for (size_t i = tail; i < line.size(); ++i) {
+            carry.push_back(line[i]);
+            carry_pos.push_back(Text_pos{ln, i});
+        }
+        if (carry.size() > m - 1) {
+            size_t drop = carry.size() - (m - 1);
+            carry.erase(0, drop);
+            carry_pos.erase(carry_pos.begin(), carry_pos.begin() + drop);
+        }
+        ++ln;
+    }
+}
+
+vector<Text_pos> find_all(Document& d, const string& s) {
+    vector<Text_pos> res;
+    for_each_match(d, Searcher{s}, [&](Text_pos p) { res.push_back(p); });
+    return res;
+}
+
+//------------------------------------------------------------------------------
+// 19.13.4 BENCHMARK: MB/s AGAINST find_txt
+//------------------------------------------------------------------------------
+
+void benchmark() {
+    Document d;
+    string text;
+    for (int i = 0; text.size() < 50'000'000; ++i)
+        text += "The quick brown fox jumps over the lazy dog, line " + to_string(i) + "\n";
+    append_text(d, text);
+    const double mb = text.size() / 1e6;
+
+    const string missing = "lazy cat";   // Not in the text: both must scan everything
+    auto t0 = steady_clock::now();
+    bool found1 = find_txt(d.begin(), d.end(), missing) != d.end();
+    auto t1 = steady_clock::now();
+    bool found2 = !find_all(d, missing).empty();
+    auto t2 = steady_clock::now();
+    size_t hits = find_all(d, "fox").size();
+    auto t3 = steady_clock::now();
+
+    cout << "find_txt:            " << mb / duration<double>(t1 - t0).count() << " MB/s (found " << found1 << ")\n";
+    cout << "find_all (no match): " << mb / duration<double>(t2 - t1).count() << " MB/s (found " << found2 << ")\n";
+    cout << "find_all (\"fox\"):    " << mb / duration<double>(t3 - t2).count() << " MB/s (" << hits << " hits)\n";
+}
+
+int main() {
+    Document d;
+    append_text(d, "Imagine a secret here,\nand a sec");
+    append_text(d, "ret that crosses a line end.\nse\ncr\net!\n");
+
+    for (Text_pos p : find_all(d, "secret"))
+        cout << "\"secret\" at line " << p.line << ", column " << p.col << "\n";
+    cout << "\"sec\\nret\" found: " << !find_all(d, "se\ncr\net").empty() << "\n";
+
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,378 @@
+/**
+ * SECTION 19.14: FROM OFFSETS TO LINES AND BACK
+ * --- THE PROBLEM ---
+ * The Document of 19.5 is a list<Line>. "Which line and column is character
+ * 12345678?" and "what is the offset of line 9000, column 4?" both mean
+ * walking the lines and adding up their sizes: O(lines) per question. A status
+ * bar asks on every keystroke; "go to offset" and mapping search hits ask too.
+ * --- THE SOLUTION ---
+ * [1] Line_index: a balanced tree (a treap, as in 19.11) with one node per
+ * line, in line order. Each node knows the number of lines and the number of
+ * characters in its subtree, so line n, the offset where it starts, and the
+ * line holding a given offset are all found by ONE walk down the tree:
+ * O(log n), with no binary search over prefix sums.
+ * [2] Typing or deleting a character changes one line length: the totals on
+ * the path from the root to that line change, O(log n). Nothing is
+ * recomputed from scratch.
+ * [3] Splitting or joining lines ('\n' typed or deleted) renumbers every line
+ * after it. In the tree that is just inserting or erasing one node, O(log n):
+ * no line number is stored anywhere, so none has to be changed.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <random>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.14.1 THE TREE OF LINES
+//------------------------------------------------------------------------------
+
+using Line = vector<char>;   // Each line keeps its '\n', except the last
+
+class Line_index {
+    struct Node {
+        list<Line>::iterator ln;   // The line itself lives in the Document's list
+        unsigned prio;             // Treap priority: parents have higher priority
+        size_t total;              // Characters in this whole subtree
+        int count;                 // Lines in this whole subtree
+        Node* left = nullptr;
+        Node* right = nullptr;
+
+        Node(list<Line>::iterator p, unsigned pr) : ln{p}, prio{pr}, total{p->size()}, count{1} { }
+    };
+
+    Node* root = nullptr;
+    mt19937 rng{1914};
+
+    static size_t total(Node* t) { return t ? t->total : 0; }
+    static int count(Node* t) { return t ? t->count : 0; }
+
+    static void update(Node* t) {
+        t->total = total(t->left) + t->ln->size() + total(t->right);
+        t->count = count(t->left) + 1 + count(t->right);
+    }
+
+    static Node* merge(Node* a, Node* b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (a->prio > b->prio) {
+            a->right = merge(a->right, b);
+            update(a);
+            return a;
+        }
+        b->left = merge(a, b->left);
+        update(b);
+        return b;
+    }
+
+    // The first tree gets lines [0:n), the second the rest
+    static pair<Node*, Node*> split(Node* t, int n) {
+        if (!t) return {nullptr, nullptr};
+        if (n <= count(t->left)) {
+            auto [a, b] = split(t->left, n);
+            t->left = b;
+            update(t);
+            return {a, t};
+        }
+        auto [a, b] = split(t->right, n - count(t->left) - 1);
+        t->right = a;
+        update(t);
+        return {t, b};
+    }
+
+    static void destroy(Node* t) {
+        if (!t) return;
+        destroy(t->left);
+        destroy(t->right);
+        delete t;
+    }
+
+public:
+    Line_index() = default;
+    Line_index(const Line_index&) = delete;
+    Line_index& operator=(const Line_index&) = delete;
+    ~Line_index() { destroy(root); }
+
+    int size() const { return count(root); }
+
+    // O(n): lines arrive in order, so only the right spine of the tree changes.
+    // Each node is pushed onto (and popped off) that spine at most once.
+    void build(list<Line>& lines) {
+        destroy(root);
+        vector<Node*> spine;
+        for (auto p = lines.begin(); p != lines.end(); ++p) {
+            Node* t = new Node{p, static_cast<unsigned>(rng())};
+            Node* last = nullptr;
+            while (!spine.empty() && spine.back()->prio < t->prio) {
+                last = spine.back();
+                spine.pop_back();
+                update(last);   // Its subtree is complete
+            }
+            t->left = last;
+            if (!spine.empty()) spine.back()->right = t;
+            spine.push_back(t);
+        }
+        for (auto q = spine.rbegin(); q != spine.rend(); ++q) update(*q);
+        root = spine.empty() ? nullptr : spine.front();
+    }
+
+    // Line n: O(log n)
+    list<Line>::iterator at(int n) const {
+        Node* t = root;
+        while (true) {
+            int lc = count(t->left);
+            if (n == lc) return t->ln;
+            if (n < lc) {
+                t = t->left;
+            } else {
+                n -= lc + 1;
+                t = t->right;
+            }
+        }
+    }
+
+    // Line n grew (or shrank) by delta characters: fix the totals on its path
+    void add(int n, long delta) {
+        Node* t = root;
+        while (true) {
+            t->total += delta;
+            int lc = count(t->left);
+            if (n == lc) return;
+            if (n < lc) {
+                t = t->left;
+            } else {
+                n -= lc + 1;
+                t = t->right;
+            }
+        }
+    }
+
+    // Total length of lines [0:n): O(log n)
+    size_t prefix(int n) const {
+        size_t sum = 0;
+        for (Node* t = root; t; ) {
+            int lc = count(t->left);
+            if (n <= lc) {
+                t = t->left;
+            } else {
+                sum += total(t->left) + t->ln->size();
+                n -= lc + 1;
+                t = t->right;
+            }
+        }
+        return sum;
+    }
+
+    // The line n holding offset, and the offset within it; (size(), rest) past the end
+    pair<int, size_t> find(size_t offset) const {
+        int n = 0;
+        for (Node* t = root; t; ) {
+            size_t lt = total(t->left);
+            if (offset < lt) {
+                t = t->left;
+            } else if (offset < lt + t->ln->size()) {
+                return {n + count(t->left), offset - lt};
+            } else {
+                offset -= lt + t->ln->size();
+                n += count(t->left) + 1;
+                t = t->right;
+            }
+        }
+        return {n, offset};
+    }
+
+    // p becomes line n; lines n and on move down one
+    void insert(int n, list<Line>::iterator p) {
+        auto [a, b] = split(root, n);
+        root = merge(merge(a, new Node{p, static_cast<unsigned>(rng())}), b);
+    }
+
+    // Line n disappears; the lines after it move up one
+    void erase(int n) {
+        auto [a, rest] = split(root, n);
+        auto [gone, b] = split(rest, 1);
+        delete gone;
+        root = merge(a, b);
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.14.2 THE DOCUMENT, WITH ITS INDEX
+//------------------------------------------------------------------------------
+
+struct Text_pos {
+    int line;
+    size_t col;
+};
+
+class Document {
+    list<Line> text;
+    Line_index index;   // Line n, and offsets, in O(log n)
+
+    // The text after col moves to a new line n+1 (col is just after a '\n')
+    void split_line(int n, size_t col) {
+        auto p = index.at(n);
+        auto q = text.insert(next(p), Line(p->begin() + col, p->end()));
+        p->erase(p->begin() + col, p->end());
+        index.add(n, -long(q->size()));
+        index.insert(n + 1, q);
+    }
+
+    // Line n+1 is appended to line n and disappears
+    void join_line(int n) {
+        auto p = index.at(n);
+        auto q = index.at(n + 1);
+        p->insert(p->end(), q->begin(), q->end());
+        index.add(n, long(q->size()));
+        index.erase(n + 1);
+        text.erase(q);
+    }
+
+public:
+    Document() { load(""); }
+
+    void load(string_view s) {
+        text.assign(1, Line{});
+        for (char c : s) {
+            text.back().push_back(c);
+            if (c == '\n') text.push_back(Line{});
+        }
+        index.build(text);
+    }
+
+    int line_count() const { return index.size(); }
+    const Line& line(int n) const { return *index.at(n); }
+    const list<Line>& lines() const { return text; }
+    size_t size() const { return index.prefix(line_count()); }
+
+    // Type c at (n, col); a '\n' splits the line
+    void insert(Text_pos p, char c) {
+        Line& ln = *index.at(p.line);
+        ln.insert(ln.begin() + p.col, c);
+        index.add(p.line, +1);
+        if (c == '\n') split_line(p.line, p.col + 1);
+    }
+
+    // Delete the character at (n, col); deleting a '\n' joins two lines
+    void erase(Text_pos p) {
+        Line& ln = *index.at(p.line);
+        char c = ln[p.col];
+        ln.erase(ln.begin() + p.col);
+        index.add(p.line, -1);
+        if (c == '\n') join_line(p.line);
+    }
+
+    // O(log n) both ways
+    size_t offset_of(Text_pos p) const { return index.prefix(p.line) + p.col; }
+
+    Text_pos position_of(size_t offset) const {
+        auto [n, col] = index.find(offset);
+        if (n == line_count()) return {n - 1, line(n - 1).size()};   // offset == size()
+        return {n, col};
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.14.3 THE OLD WAY: WALK THE LINES
+//------------------------------------------------------------------------------
+
+size_t walk_offset_of(const Document& d, Text_pos p) {
+    size_t off = 0;
+    auto ln = d.lines().begin();
+    for (int n = 0; n < p.line; ++n, ++ln) off += ln->size();
+    return off + p.col;
+}
+
+Text_pos walk_position_of(const Document& d, size_t offset) {
+    int n = 0;
+    auto ln = d.lines().begin();
+    for (; next(ln) != d.lines().end() && offset >= ln->size(); ++n, ++ln) offset -= ln->size();
+    return {n, offset};
+}
+
+//------------------------------------------------------------------------------
+// 19.14.4 BENCHMARK
+//------------------------------------------------------------------------------
+
+void benchmark() {
+    string text;
+    for (int i = 0; i < 1'000'000; ++i)
+        text += "line " + to_string(i) + ": some text that a status bar must locate\n";
+    Document d;
+    mt19937 rng{42};
+
+    const int indexed_queries = 1'000'000;
+    const int walk_queries = 200;   // Each one is O(lines): keep it short
+    size_t check = 0;
+
+    auto t0 = steady_clock::now();
+    d.load(text);   // Builds the index
+    auto t1 = steady_clock::now();
+    for (int i = 0; i < indexed_queries; ++i) {
+        Text_pos p = d.position_of(rng() % d.size());
+        check += d.offset_of(p);
+    }
+    auto t2 = steady_clock::now();
+    for (int i = 0; i < walk_queries; ++i) {
+        Text_pos p = walk_position_of(d, rng() % text.size());
+        check += walk_offset_of(d, p);
+    }
+    auto t3 = steady_clock::now();
+
+    // Typing: every keystroke updates the index, then the status bar asks
+    const int keys = 1'000'000;
+    auto t4 = steady_clock::now();
+    for (int i = 0; i < keys; ++i) {
+        Text_pos p{int(rng() % d.line_count()), 0};
+        d.insert(p, 'x');
+        check += d.offset_of(p);
+    }
+    auto t5 = steady_clock::now();
+
+    // Enter in the middle of a line, a query, then Backspace over that '\n'
+    // joins the lines again, and another query
+    auto t6 = steady_clock::now();
+    for (int i = 0; i < keys; ++i) {
+        int n = rng() % (d.line_count() - 1);
+        Text_pos p{n, 1 + rng() % (d.line(n).size() - 1)};
+        d.insert(p, '\n');
+        check += d.offset_of({n + 1, 0});
+        d.erase(p);
+        check += d.position_of(d.offset_of(p)).line;
+    }
+    auto t7 = steady_clock::now();
+
+    cout << "load + build index: " << duration<double, milli>(t1 - t0).count() << "ms for "
+         << d.line_count() << " lines\n";
+    cout << "indexed round trip: " << duration<double, nano>(t2 - t1).count() / indexed_queries << "ns\n";
+    cout << "walking round trip: " << duration<double, nano>(t3 - t2).count() / walk_queries << "ns\n";
+    cout << "keystroke + query:  " << duration<double, nano>(t5 - t4).count() / keys << "ns\n";
+    cout << "split + query + join + query: " << duration<double, nano>(t7 - t6).count() / keys << "ns"
+         << " (check " << check % 1000 << ", same size: " << (d.size() == text.size() + keys) << ")\n";
+}
+
+int main() {
+    Document d;
+    d.load("Hello\nbig\nworld!");
+    d.insert({1, 3}, '!');           // "big!": O(log n) index update
+    d.insert({0, 2}, '\n');          // "He" "llo": one node inserted into the index
+    d.erase({1, 3});                 // Delete the '\n' after "llo": joins "llo" and "big!"
+
+    for (int n = 0; n < d.line_count(); ++n)
+        cout << n << ": " << string(d.line(n).begin(), d.line(n).end())
+             << (n + 1 < d.line_count() ? "" : "\n");
+    Text_pos p = d.position_of(7);
+    cout << "offset 7 is line " << p.line << ", column " << p.col
+         << "; line 2, column 1 is offset " << d.offset_of({2, 1}) << "\n";
+
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,340 @@
+/**
+ * SECTION 19.15: OPENING HUGE FILES INSTANTLY
+ * --- THE PROBLEM ---
+ * Loading a file into the 19.5 Document copies every byte into a vector<char>
+ * per line, allocating a list node and a vector for each one. A 4GB log takes
+ * tens of seconds and 4GB+ of RAM before the first line can be shown.
+ * --- THE SOLUTION ---
+ * [1] mmap: ask the operating system to map the file into our address space.
+ * Nothing is read yet; pages are brought in when first touched, and they
+ * live in the OS page cache, not on our heap.
+ * [2] Background line index: a worker thread finds the '\n's with memchr and
+ * publishes line starts a chunk at a time. Asking for line n waits only
+ * until the index has reached line n, so the first screen appears after the
+ * first chunk, however big the file is.
+ * [3] Segments: the document is a list of segments, each either "lines
+ * [first:last) of the file, unchanged" or one edited Line. Unchanged lines
+ * are served as string_views straight out of the mapping. Editing a line
+ * splits its segment and MATERIALIZES only that one line into a vector<char>.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <list>
+#include <string>
+#include <string_view>
+#include <cstring>            // For memchr
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <filesystem>
+#include <chrono>
+
+#include <fcntl.h>            // POSIX: open
+#include <sys/mman.h>         // POSIX: mmap, munmap
+#include <sys/stat.h>         // POSIX: fstat
+#include <unistd.h>           // POSIX: close
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.15.1 THE MAPPING
+//------------------------------------------------------------------------------
+
+class Mapped_file {
+    const char* data = nullptr;
+    size_t sz = 0;
+
+public:
+    explicit Mapped_file(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error{"Mapped_file: cannot open " + path};
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            close(fd);
+            throw runtime_error{"Mapped_file: cannot stat " + path};
+        }
+        sz = st.st_size;
+        if (sz) {   // mmap of 0 bytes fails: an empty file just has no data
+            void* p = mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw runtime_error{"Mapped_file: cannot map " + path};
+            }
+            data = static_cast<const char*>(p);
+        }
+        close(fd);   // The mapping keeps the file alive
+    }
+    Mapped_file(const Mapped_file&) = delete;
+    Mapped_file& operator=(const Mapped_file&) = delete;
+    ~Mapped_file() { if (data) munmap(const_cast<char*>(data), sz); }
+
+    const char* begin() const { return data; }
+    size_t size() const { return sz; }
+};
+
+//------------------------------------------------------------------------------
+// 19.15.2 THE BACKGROUND LINE INDEX
+//------------------------------------------------------------------------------
+
+class Line_starts {
+    const char* data;
+    size_t sz;
+    vector<size_t> starts{0};   // starts[n]: offset of line n (each line keeps its '\n')
+    bool done = false;
+    atomic<bool> stop{false};
+    mutable mutex m;
+    mutable condition_variable cv;
+    thread worker;
+
+    static constexpr size_t chunk = 1 << 20;   // Publish every 1MB
+
+    void run() {
+        vector<size_t> found;
+        for (size_t pos = 0; pos < sz && !stop; ) {
+            size_t end = min(sz, pos + chunk);
+            found.clear();
+            while (const char* nl = static_cast<const char*>(memchr(data + pos, '\n', end - pos))) {
+                pos = nl - data + 1;
+                found.push_back(pos);
+            }
+            pos = end;
+            lock_guard lock{m};
+            starts.insert(starts.end(), found.begin(), found.end());
+            cv.notify_all();
+        }
+        lock_guard lock{m};
+        done = true;
+        cv.notify_all();
+    }
+
+    // Wait until line n's start and end are both known (or the scan is done)
+    void wait_for(size_t n, unique_lock<mutex>& lock) const {
+        cv.wait(lock, [&] { return done || n + 1 < starts.size(); });
+    }
+
+public:
+    Line_starts(const char* d, size_t n) : data{d}, sz{n}, worker{[this] { run(); }} { }
+    Line_starts(const Line_starts&) = delete;
+    Line_starts& operator=(const Line_starts&) = delete;
+    ~Line_starts() {
+        stop = true;
+        worker.join();
+    }
+
+    // [begin:end) of line n in the file
+    pair<size_t, size_t> line(size_t n) const {
+        unique_lock lock{m};
+        wait_for(n, lock);
+        if (n >= starts.size()) throw out_of_range{"Line_starts::line()"};
+        return {starts[n], n + 1 < starts.size() ? starts[n + 1] : sz};
+    }
+
+    // Waits for the whole file to be indexed
+    size_t count() const {
+        unique_lock lock{m};
+        cv.wait(lock, [&] { return done; });
+        return starts.size();
+    }
+
+    size_t indexed() const {
+        lock_guard lock{m};
+        return starts.size();
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.15.3 THE DOCUMENT: MAPPED SEGMENTS AND MATERIALIZED LINES
+//------------------------------------------------------------------------------
+
+using Line = vector<char>;
+
+class Mapped_document {
+    static constexpr size_t to_end = size_t(-1);
+
+    struct Segment {
+        size_t first = 0;     // File lines [first:last); last == to_end: "to the end of the file"
+        size_t last = 0;
+        bool mapped = true;
+        Line text;            // The line itself, if !mapped
+
+        Segment(size_t f, size_t l) : first{f}, last{l} { }
+        explicit Segment(string_view s) : mapped{false}, text(s.begin(), s.end()) { }
+    };
+
+    Mapped_file file;         // Declared before index: the worker must stop first
+    Line_starts index;
+    list<Segment> segs;
+    size_t edited = 0;
+
+    size_t seg_lines(const Segment& s) const {
+        if (!s.mapped) return 1;
+        return (s.last == to_end ? index.count() : s.last) - s.first;
+    }
+
+    // Find the segment holding document line n, and n's place within it.
+    // Only the last mapped segment can be open-ended, and we stop inside it
+    // without asking for its length, so early lines never wait for the index.
+    pair<list<Segment>::iterator, size_t> locate(size_t n) {
+        for (auto p = segs.begin(); p != segs.end(); ++p) {
+            if (p->mapped && p->last == to_end) return {p, n};
+            size_t k = seg_lines(*p);
+            if (n < k) return {p, n};
+            n -= k;
+        }
+        throw out_of_range{"Mapped_document: no such line"};
+    }
+
+    // Make line n a segment of its own; return it
+    list<Segment>::iterator isolate(size_t n) {
+        auto [p, k] = locate(n);
+        if (!p->mapped) return p;
+        size_t line = p->first + k;
+        index.line(line);   // Throws if the line does not exist
+        if (p->last != line + 1)   // Split off the rest (still open-ended, if p was)
+            segs.insert(next(p), Segment{line + 1, p->last});
+        p->last = line + 1;
+        if (k > 0) {   // Split off the front
+            segs.insert(p, Segment{p->first, line});
+            p->first = line;
+        }
+        return p;
+    }
+
+public:
+    explicit Mapped_document(const string& path)
+        : file{path}, index{file.begin(), file.size()} {
+        segs.push_back(Segment{0, to_end});
+    }
+
+    // Line n: a view of the file, or of the edited copy
+    string_view line(size_t n) {
+        auto [p, k] = locate(n);
+        if (!p->mapped) return {p->text.data(), p->text.size()};
+        auto [b, e] = index.line(p->first + k);
+        return {file.begin() + b, e - b};
+    }
+
+    // Copy line n out of the mapping so it can be changed (once only)
+    Line& edit(size_t n) {
+        auto p = isolate(n);
+        if (p->mapped) {
+            auto [b, e] = index.line(p->first);
+            p->text.assign(file.begin() + b, file.begin() + e);
+            p->mapped = false;
+            ++edited;
+        }
+        return p->text;
+    }
+
+    void insert_line(size_t n, string_view s) {
+        auto p = n == 0 ? segs.begin() : next(isolate(n - 1));
+        segs.insert(p, Segment{s});
+        ++edited;
+    }
+
+    void erase_line(size_t n) {
+        auto p = isolate(n);
+        if (!p->mapped) --edited;
+        segs.erase(p);
+    }
+
+    // Waits for the index; everything else works while it is still running
+    size_t line_count() const {
+        size_t n = 0;
+        for (const Segment& s : segs) n += seg_lines(s);
+        return n;
+    }
+
+    size_t materialized() const { return edited; }
+    size_t segments() const { return segs.size(); }
+    size_t indexed_lines() const { return index.indexed(); }
+};
+
+//------------------------------------------------------------------------------
+// 19.15.4 BENCHMARK: TIME TO FIRST SCREEN
+//------------------------------------------------------------------------------
+
+// The 19.5 way: read everything into a list of vectors
+list<Line> eager_load(const string& path) {
+    ifstream is{path, ios::binary};
+    string all{istreambuf_iterator<char>{is}, istreambuf_iterator<char>{}};
+    list<Line> lines(1);
+    for (char c : all) {
+        lines.back().push_back(c);
+        if (c == '\n') lines.push_back(Line{});
+    }
+    return lines;
+}
+
+string make_file(size_t bytes) {
+    string path = (filesystem::temp_directory_path() / ("ch19_15_" + to_string(bytes) + ".log")).string();
+    ofstream os{path, ios::binary};
+    string s;
+    size_t written = 0;   // Flushed so far; the file ends up just over 'bytes'
+    for (long i = 0; written + s.size() < bytes; ++i) {
+        s += "2024-01-01 12:00:00 INFO request " + to_string(i) + " served in 3ms\n";
+        if (s.size() > (1 << 20)) { os << s; written += s.size(); s.clear(); }
+    }
+    os << s;
+    return path;
+}
+
+void first_screen(const string& path, size_t mb) {
+    auto t0 = steady_clock::now();
+    Mapped_document doc{path};
+    size_t chars = 0;
+    for (size_t n = 0; n < 50; ++n) chars += doc.line(n).size();   // One screenful
+    auto t1 = steady_clock::now();
+
+    doc.edit(10).push_back('!');   // Edit near the top: only this line is copied
+    doc.insert_line(20, "a new line\n");
+    auto t2 = steady_clock::now();
+    size_t lines = doc.line_count();   // Needs the whole index
+    string_view last = doc.line(lines - 2);
+    auto t3 = steady_clock::now();
+
+    cout << mb << "MB mapped: first screen " << duration<double, milli>(t1 - t0).count()
+         << "ms; full index " << duration<double, milli>(t3 - t2).count() << "ms, "
+         << lines << " lines, " << doc.materialized() << " materialized, last: " << last;
+}
+
+void benchmark() {
+    for (size_t mb : {64, 512}) {
+        string path = make_file(mb << 20);
+        first_screen(path, mb);
+
+        if (mb == 64) {   // The eager load is slow and needs RAM for every line
+            auto t0 = steady_clock::now();
+            list<Line> lines = eager_load(path);
+            auto t1 = steady_clock::now();
+            size_t bytes = 0;
+            for (const Line& ln : lines) bytes += 2 * sizeof(void*) + sizeof(Line) + ln.capacity();
+            cout << mb << "MB eager:  first screen " << duration<double, milli>(t1 - t0).count()
+                 << "ms, " << bytes / 1'000'000 << "MB of heap\n";
+        }
+        filesystem::remove(path);
+    }
+}
+
+int main() {
+    string path = (filesystem::temp_directory_path() / "ch19_15_demo.txt").string();
+    { ofstream os{path}; os << "first\nsecond\nthird"; }
+
+    Mapped_document doc{path};
+    Line& ln = doc.edit(1);            // "second\n" is copied; the rest stays mapped
+    ln.insert(ln.begin(), '2');
+    doc.insert_line(0, "zeroth\n");
+    doc.erase_line(3);                 // "third"
+
+    for (size_t n = 0; n < doc.line_count(); ++n) cout << n << ": " << doc.line(n);
+    cout << "(" << doc.segments() << " segments, " << doc.materialized() << " lines materialized)\n";
+    filesystem::remove(path);
+
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,342 @@
+/**
+ * SECTION 19.16: UNDO AND REDO
+ * --- THE PROBLEM ---
+ * The 19.5 Document has no undo. Copying the whole Document before each
+ * risky change costs O(document) time and memory per snapshot.
+ * --- THE SOLUTION ---
+ * [1] Journal the EDITS, not the text: each change is a Delta "inserted (or
+ * erased) these characters at (line, col)". Undo applies the inverse edit,
+ * redo applies it again: O(size of the delta), whatever the document size.
+ * [2] Compact: a Delta is a small fixed-size record; the characters of ALL
+ * deltas live back to back in one string (the arena). No allocation per edit.
+ * [3] Coalescing: typing "hello" is five inserts, but one undo step. A new
+ * keystroke that continues the previous one extends that Delta instead of
+ * adding another. Backspace runs coalesce too (their text grows leftwards,
+ * so it is stored reversed).
+ * [4] Budget: when the journal exceeds its memory budget, the OLDEST deltas
+ * are dropped. You lose the ability to undo that far back, nothing else.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <random>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.16.1 THE DOCUMENT: INSERT AND ERASE TEXT AT A POSITION
+//------------------------------------------------------------------------------
+
+using Line = vector<char>;   // Each line keeps its '\n', except the last
+
+struct Text_pos {
+    int line;
+    size_t col;
+};
+
+class Document {
+    list<Line> lines;
+    vector<list<Line>::iterator> by_number;   // Line n in O(1)
+
+public:
+    Document() {
+        lines.push_back(Line{});
+        by_number.push_back(lines.begin());
+    }
+
+    int line_count() const { return int(by_number.size()); }
+    const Line& line(int n) const { return *by_number[n]; }
+
+    // Insert s before p; every '\n' in s starts a new line
+    void insert(Text_pos p, string_view s) {
+        Line& ln = *by_number[p.line];
+        if (s.find('\n') == string_view::npos) {   // The common case: one line
+            ln.insert(ln.begin() + p.col, s.begin(), s.end());
+            return;
+        }
+        Line tail(ln.begin() + p.col, ln.end());
+        ln.erase(ln.begin() + p.col, ln.end());
+        auto cur = by_number[p.line];
+        vector<list<Line>::iterator> added;
+        for (char c : s) {
+            cur->push_back(c);
+            if (c == '\n') {
+                cur = lines.insert(next(cur), Line{});
+                added.push_back(cur);
+            }
+        }
+        cur->insert(cur->end(), tail.begin(), tail.end());
+        by_number.insert(by_number.begin() + p.line + 1, added.begin(), added.end());
+    }
+
+    // Erase n characters from p (fewer at the end of the text); return them
+    string erase(Text_pos p, size_t n) {
+        string gone;
+        Line& ln = *by_number[p.line];
+        while (gone.size() < n) {
+            size_t k = min(n - gone.size(), ln.size() - p.col);
+            bool joins = k > 0 && p.col + k == ln.size() && ln.back() == '\n';
+            gone.append(ln.begin() + p.col, ln.begin() + p.col + k);
+            ln.erase(ln.begin() + p.col, ln.begin() + p.col + k);
+            if (!joins) break;
+            // We erased the '\n': the next line becomes part of this one
+            auto nx = by_number[p.line + 1];
+            ln.insert(ln.end(), nx->begin(), nx->end());
+            lines.erase(nx);
+            by_number.erase(by_number.begin() + p.line + 1);
+        }
+        return gone;
+    }
+
+    string str() const {
+        string s;
+        for (const Line& ln : lines) s.append(ln.begin(), ln.end());
+        return s;
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.16.2 THE JOURNAL
+//------------------------------------------------------------------------------
+
+class Journal {
+    enum class Kind : unsigned char { insert, erase, erase_back };
+
+    struct Delta {          // 24 bytes, whatever the size of the edit
+        size_t off;         // Where the text starts in the arena (see base)
+        int line;
+        unsigned col;
+        unsigned len;
+        Kind kind;
+        bool multiline;     // The text holds a '\n': never extend this delta
+    };
+
+    static constexpr unsigned max_run = 4096;   // Longest coalesced run
+
+    deque<Delta> log;       // Oldest first; [0:cur) are applied, [cur:) can be redone
+    size_t cur = 0;
+    string arena;           // The text of every delta, in log order
+    size_t base = 0;        // Arena offset of arena[0] (the front gets trimmed)
+    size_t budget;
+    bool coalesce = true;
+
+    string_view text(const Delta& d) const { return {arena.data() + (d.off - base), d.len}; }
+    size_t end_of(const Delta& d) const { return d.off + d.len; }
+
+    // A new edit makes everything after cur unreachable
+    void drop_redo() {
+        if (cur == log.size()) return;
+        arena.resize((cur ? end_of(log[cur - 1]) : log[cur].off) - base);
+        log.erase(log.begin() + cur, log.end());
+    }
+
+    void push(Text_pos p, string_view s, Kind k) {
+        log.push_back(Delta{base + arena.size(), p.line, unsigned(p.col), unsigned(s.size()), k,
+                            s.find('\n') != string_view::npos});
+        arena += s;
+        cur = log.size();
+        coalesce = true;
+        enforce_budget();
+    }
+
+    // Forget the oldest deltas until we fit; trim the arena only when
+    // half of it is dead, so dropping is amortized O(1). The dead front is
+    // not history, so it doesn't count against the budget (see memory())
+    void enforce_budget() {
+        while (log.size() > 1 && memory() > budget) {
+            log.pop_front();
+            --cur;
+            size_t dead = log.front().off - base;
+            if (dead > arena.size() / 2) {
+                arena.erase(0, dead);
+                base += dead;
+            }
+        }
+    }
+
+    // The last delta, if the next edit may extend it
+    Delta* extendable() {
+        if (!coalesce || cur == 0 || cur != log.size()) return nullptr;
+        Delta& d = log.back();
+        return d.multiline || d.len >= max_run ? nullptr : &d;
+    }
+
+public:
+    explicit Journal(size_t bytes = 64 << 20) : budget{bytes} { }
+
+    void record_insert(Text_pos p, string_view s) {
+        if (s.empty()) return;
+        drop_redo();
+        if (Delta* d = extendable(); d && d->kind == Kind::insert && s.find('\n') == string_view::npos
+                                     && d->line == p.line && d->col + d->len == p.col) {
+            arena += s;      // Typing on: the text just grows
+            d->len += s.size();
+            enforce_budget();
+            return;
+        }
+        push(p, s, Kind::insert);
+    }
+
+    void record_erase(Text_pos p, string_view gone) {
+        if (gone.empty()) return;
+        drop_redo();
+        Delta* d = extendable();
+        if (d && gone.find('\n') == string_view::npos && d->line == p.line) {
+            if (d->kind == Kind::erase && d->col == p.col) {   // Delete key: same place
+                arena += gone;
+                d->len += gone.size();
+                enforce_budget();
+                return;
+            }
+            if ((d->kind == Kind::erase_back || (d->kind == Kind::erase && d->len == 1))
+                && p.col + gone.size() == d->col) {            // Backspace: moving left
+                arena.append(gone.rbegin(), gone.rend());
+                d->kind = Kind::erase_back;
+                d->col = p.col;
+                d->len += gone.size();
+                enforce_budget();
+                return;
+            }
+        }
+        push(p, gone, Kind::erase);
+    }
+
+    // Stop coalescing: the next edit starts a new undo step (cursor moved, etc.)
+    void break_run() { coalesce = false; }
+
+    // Apply the inverse of the last applied delta: O(delta)
+    bool undo(Document& doc) {
+        if (cur == 0) return false;
+        const Delta& d = log[--cur];
+        Text_pos p{d.line, d.col};
+        string_view s = text(d);
+        switch (d.kind) {
+        case Kind::insert:     doc.erase(p, d.len); break;
+        case Kind::erase:      doc.insert(p, s); break;
+        case Kind::erase_back: doc.insert(p, string(s.rbegin(), s.rend())); break;
+        }
+        coalesce = false;
+        return true;
+    }
+
+    bool redo(Document& doc) {
+        if (cur == log.size()) return false;
+        const Delta& d = log[cur++];
+        if (d.kind == Kind::insert) doc.insert({d.line, d.col}, text(d));
+        else doc.erase({d.line, d.col}, d.len);
+        coalesce = false;
+        return true;
+    }
+
+    // Bytes of undo history: the deltas and their text. The arena may also
+    // hold up to as many dead bytes again, until it is next trimmed
+    size_t memory() const {
+        size_t text = log.empty() ? 0 : base + arena.size() - log.front().off;
+        return text + log.size() * sizeof(Delta);
+    }
+    size_t steps() const { return log.size(); }
+    size_t undoable() const { return cur; }
+};
+
+// Edit the document and journal the edit
+void insert(Document& d, Journal& j, Text_pos p, string_view s) {
+    d.insert(p, s);
+    j.record_insert(p, s);
+}
+
+void erase(Document& d, Journal& j, Text_pos p, size_t n) {
+    string gone = d.erase(p, n);
+    j.record_erase(p, gone);
+}
+
+//------------------------------------------------------------------------------
+// 19.16.3 BENCHMARK: MEMORY PER 1M EDITS AND UNDO LATENCY
+//------------------------------------------------------------------------------
+
+/* * A typist: mostly typing at the cursor, some backspacing, now and then
+ * Enter or a click somewhere else (which ends the current undo step).
+ */
+void benchmark() {
+    const int edits = 1'000'000;
+    Document doc;
+    Journal journal{size_t(1) << 30};
+    mt19937 rng{8};
+
+    Text_pos cursor{0, 0};
+    auto t0 = steady_clock::now();
+    for (int i = 0; i < edits; ++i) {
+        int r = rng() % 100;
+        if (r == 0) {   // Click somewhere
+            journal.break_run();
+            cursor.line = rng() % doc.line_count();
+            cursor.col = rng() % (doc.line(cursor.line).size() + 1);
+            if (cursor.col && doc.line(cursor.line)[cursor.col - 1] == '\n') --cursor.col;
+        } else if (r < 3) {   // Enter
+            insert(doc, journal, cursor, "\n");
+            cursor = {cursor.line + 1, 0};
+        } else if (r < 15 && cursor.col > 0) {   // Backspace
+            --cursor.col;
+            erase(doc, journal, cursor, 1);
+        } else {
+            insert(doc, journal, cursor, string(1, char('a' + rng() % 26)));
+            ++cursor.col;
+        }
+    }
+    auto t1 = steady_clock::now();
+
+    // What one heap-allocated Delta per keystroke would cost (string + position + kind)
+    size_t naive = edits * (sizeof(string) + sizeof(Text_pos) + sizeof(int));
+    cout << edits << " edits: journal " << journal.memory() / 1000 << "KB in " << journal.steps()
+         << " steps (" << double(journal.memory()) / edits << " bytes/edit); one Delta per keystroke ~"
+         << naive / 1000 << "KB; one snapshot of the text " << doc.str().size() / 1000 << "KB\n";
+    cout << "edit + journal: " << duration<double, nano>(t1 - t0).count() / edits << "ns per edit\n";
+
+    // Undo and redo everything
+    string final_text = doc.str();
+    size_t steps = journal.undoable();
+    auto t2 = steady_clock::now();
+    while (journal.undo(doc)) { }
+    auto t3 = steady_clock::now();
+    bool empty = doc.str().empty();
+    while (journal.redo(doc)) { }
+    auto t4 = steady_clock::now();
+    cout << "undo: " << duration<double, micro>(t3 - t2).count() / steps << "us per step (back to empty: "
+         << empty << "); redo: " << duration<double, micro>(t4 - t3).count() / steps
+         << "us per step (same text: " << (doc.str() == final_text) << ")\n";
+
+    // Budget: the same session with 64KB of undo history
+    Document small;
+    Journal capped{64 << 10};
+    for (int i = 0; i < 100'000; ++i) {
+        if (i % 10 == 0) capped.break_run();
+        insert(small, capped, {0, small.line(0).size()}, "x");
+    }
+    cout << "64KB budget: " << capped.memory() / 1000 << "KB used, " << capped.steps() << " steps kept\n";
+}
+
+int main() {
+    Document doc;
+    Journal journal;
+    for (char c : string{"Hello wrld"}) insert(doc, journal, {0, doc.line(0).size()}, string(1, c));
+    for (int i = 0; i < 3; ++i) erase(doc, journal, {0, doc.line(0).size() - 1}, 1);   // Backspace x3
+    journal.break_run();
+    insert(doc, journal, {0, doc.line(0).size()}, "orld!\nSecond line");
+    cout << doc.str() << "\n(" << journal.steps() << " undo steps)\n";
+
+    journal.undo(doc);
+    cout << "undo:  " << doc.str() << "\n";
+    journal.undo(doc);
+    cout << "undo:  " << doc.str() << "\n";
+    journal.redo(doc);
+    cout << "redo:  " << doc.str() << "\n";
+
+    benchmark();
+    return 0;
+}
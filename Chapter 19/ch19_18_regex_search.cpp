@@ -0,0 +1,552 @@
+/**
+ * SECTION 19.18: REGULAR EXPRESSION SEARCH IN LINEAR TIME
+ * --- THE PROBLEM ---
+ * find_txt() only finds literal strings. std::regex wants the text in one
+ * contiguous string (so we would copy the whole Document), and it is a
+ * BACKTRACKING matcher: for patterns like (a|aa)*b the time can explode
+ * exponentially with the length of the line.
+ * --- THE SOLUTION ---
+ * [1] Parse the pattern into a tree, then compile the tree into an NFA: a
+ * little program of "match a character in this set", "split" (try both
+ * ways) and "jump" instructions (Thompson's construction).
+ * [2] Run ALL the possible paths at once, as a set of NFA states, one
+ * character at a time. No path is ever tried twice, so the time is linear
+ * in the text, whatever the pattern.
+ * [3] Lazy DFA: a set of NFA states becomes one DFA state, and its
+ * transitions are computed the first time they are needed, then CACHED. Most
+ * characters then cost a single table lookup. The cache has a size limit;
+ * if it fills up it is simply flushed.
+ * [4] The DFA tells us which lines contain a match. Only for those lines do
+ * we find where the matches are: one right-to-left pass of the REVERSED
+ * pattern's NFA records, for each start position, the longest match
+ * starting there. Then leftmost-longest matches are read off left to right.
+ * [5] Lines are searched in place, as spans; nothing is copied. '.' and
+ * [^...] do not match '\n', so (as in grep) a match lies within one line.
+ * [6] A search fills in the cache, so searching is not const: a Regex is
+ * used by one thread at a time.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <map>
+#include <array>
+#include <bitset>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <cctype>       // For isalnum
+#include <stdexcept>
+#include <regex>
+#include <random>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.18.1 PARSING: PATTERN -> TREE
+//------------------------------------------------------------------------------
+
+using Char_set = bitset<256>;
+
+struct Regex_node {
+    enum Kind { chars, cat, alt, star, plus, opt, empty };
+    Kind kind;
+    Char_set set;   // For chars
+    int a = -1;     // Operands: indices into the node pool
+    int b = -1;
+};
+
+/* * Grammar (precedence from low to high):
+ *   Alt:  Cat { '|' Cat }
+ *   Cat:  { Rep }
+ *   Rep:  Atom { '*' | '+' | '?' }
+ *   Atom: '(' Alt ')' | '[' Class ']' | '.' | '\' Escape | Character
+ */
+class Regex_parser {
+    string_view s;
+    size_t i = 0;
+
+    [[noreturn]] void error(const string& msg) {
+        throw runtime_error{"Regex: " + msg + " at position " + to_string(i)};
+    }
+
+    int node(Regex_node::Kind k, int a = -1, int b = -1) {
+        nodes.push_back(Regex_node{k, {}, a, b});
+        return int(nodes.size()) - 1;
+    }
+
+    int chars(const Char_set& cs) {
+        int n = node(Regex_node::chars);
+        nodes[n].set = cs;
+        return n;
+    }
+
+    Char_set escape(char c) {
+        Char_set cs;
+        switch (c) {
+        case 'd': for (char x = '0'; x <= '9'; ++x) cs.set(static_cast<unsigned char>(x)); break;
+        case 'w':
+            for (int x = 0; x < 256; ++x) if (isalnum(x) || x == '_') cs.set(x);
+            break;
+        case 's': for (char x : string_view{" \t\n\r\f\v"}) cs.set(static_cast<unsigned char>(x)); break;
+        case 'n': cs.set('\n'); break;
+        case 't': cs.set('\t'); break;
+        default: cs.set(static_cast<unsigned char>(c));   // \. \* \\ and so on
+        }
+        return cs;
+    }
+
+    int parse_alt() {
+        int left = parse_cat();
+        while (i < s.size() && s[i] == '|') {
+            ++i;
+            left = node(Regex_node::alt, left, parse_cat());
+        }
+        return left;
+    }
+
+    int parse_cat() {
+        int left = -1;
+        while (i < s.size() && s[i] != '|' && s[i] != ')') {
+            int r = parse_rep();
+            left = left < 0 ? r : node(Regex_node::cat, left, r);
+        }
+        return left < 0 ? node(Regex_node::empty) : left;
+    }
+
+    int parse_rep() {
+        int a = parse_atom();
+        while (i < s.size()) {
+            if (s[i] == '*') a = node(Regex_node::star, a);
+            else if (s[i] == '+') a = node(Regex_node::plus, a);
+            else if (s[i] == '?') a = node(Regex_node::opt, a);
+            else break;
+            ++i;
+        }
+        return a;
+    }
+
+    int parse_atom() {
+        char c = s[i++];
+        switch (c) {
+        case '(': {
+            int a = parse_alt();
+            if (i == s.size() || s[i] != ')') error("missing )");
+            ++i;
+            return a;
+        }
+        case '[': return chars(parse_class());
+        case '.': return chars(Char_set{}.set().reset('\n'));
+        case '\\':
+            if (i == s.size()) error("trailing \\");
+            return chars(escape(s[i++]));
+        case '*': case '+': case '?': case ')':
+            --i;
+            error(string{"unexpected "} + c);
+        default: {
+            Char_set cs;
+            cs.set(static_cast<unsigned char>(c));
+            return chars(cs);
+        }
+        }
+    }
+
+    // After '[': [abc], [a-z0-9_], [^\n], ...
+    Char_set parse_class() {
+        Char_set cs;
+        bool negate = i < s.size() && s[i] == '^';
+        if (negate) ++i;
+        bool first = true;
+        while (i < s.size() && (s[i] != ']' || first)) {
+            first = false;
+            if (s[i] == '\\' && i + 1 < s.size()) {
+                cs |= escape(s[i + 1]);
+                i += 2;
+                continue;
+            }
+            unsigned char lo = s[i++];
+            unsigned char hi = lo;
+            if (i + 1 < s.size() && s[i] == '-' && s[i + 1] != ']') {
+                hi = s[i + 1];
+                i += 2;
+                if (hi < lo) error("bad range");
+            }
+            for (int x = lo; x <= hi; ++x) cs.set(x);
+        }
+        if (i == s.size()) error("missing ]");
+        ++i;
+        if (negate) {
+            cs = ~cs;
+            cs.reset('\n');
+        }
+        return cs;
+    }
+
+public:
+    vector<Regex_node> nodes;
+    int root;
+
+    explicit Regex_parser(string_view pattern) : s{pattern} {
+        root = parse_alt();
+        if (i != s.size()) error("unexpected )");
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.18.2 COMPILING: TREE -> NFA PROGRAM
+//------------------------------------------------------------------------------
+
+struct Inst {
+    enum Op { chars, split, jmp, match };
+    Op op;
+    int x = 0;   // chars: index of the Char_set; split/jmp: target
+    int y = 0;   // split: second target
+};
+
+struct Program {
+    vector<Inst> code;
+    vector<Char_set> sets;
+};
+
+/* * Thompson's construction, emitting code directly:
+ *   e1|e2:  split L1, L2;  L1: e1;  jmp L3;  L2: e2;  L3:
+ *   e*:     L1: split L2, L3;  L2: e;  jmp L1;  L3:
+ *   e+:     L1: e;  split L1, L3;  L3:
+ *   e?:     split L1, L2;  L1: e;  L2:
+ * With reverse == true, every concatenation is emitted back to front: the
+ * program then matches the reversed text.
+ */
+void emit(const vector<Regex_node>& nodes, int n, Program& p, bool reverse) {
+    const Regex_node& r = nodes[n];
+    auto here = [&] { return int(p.code.size()); };
+    switch (r.kind) {
+    case Regex_node::empty: break;
+    case Regex_node::chars:
+        p.code.push_back({Inst::chars, int(p.sets.size())});
+        p.sets.push_back(r.set);
+        break;
+    case Regex_node::cat:
+        emit(nodes, reverse ? r.b : r.a, p, reverse);
+        emit(nodes, reverse ? r.a : r.b, p, reverse);
+        break;
+    case Regex_node::alt: {
+        int sp = here();
+        p.code.push_back({Inst::split, sp + 1});
+        emit(nodes, r.a, p, reverse);
+        int j = here();
+        p.code.push_back({Inst::jmp});
+        p.code[sp].y = here();
+        emit(nodes, r.b, p, reverse);
+        p.code[j].x = here();
+        break;
+    }
+    case Regex_node::star: {
+        int sp = here();
+        p.code.push_back({Inst::split, sp + 1});
+        emit(nodes, r.a, p, reverse);
+        p.code.push_back({Inst::jmp, sp});
+        p.code[sp].y = here();
+        break;
+    }
+    case Regex_node::plus: {
+        int start = here();
+        emit(nodes, r.a, p, reverse);
+        p.code.push_back({Inst::split, start, here() + 1});
+        break;
+    }
+    case Regex_node::opt: {
+        int sp = here();
+        p.code.push_back({Inst::split, sp + 1});
+        emit(nodes, r.a, p, reverse);
+        p.code[sp].y = here();
+        break;
+    }
+    }
+}
+
+Program compile(const Regex_parser& parsed, bool reverse) {
+    Program p;
+    emit(parsed.nodes, parsed.root, p, reverse);
+    p.code.push_back({Inst::match});
+    return p;
+}
+
+// Add pc and everything reachable from it without reading a character
+void closure(const Program& p, int pc, vector<int>& out, vector<char>& seen) {
+    vector<int> stack{pc};
+    while (!stack.empty()) {
+        int q = stack.back();
+        stack.pop_back();
+        if (seen[q]) continue;
+        seen[q] = 1;
+        const Inst& in = p.code[q];
+        if (in.op == Inst::jmp) stack.push_back(in.x);
+        else if (in.op == Inst::split) { stack.push_back(in.y); stack.push_back(in.x); }
+        else out.push_back(q);   // chars or match: a real state
+    }
+}
+
+//------------------------------------------------------------------------------
+// 19.18.3 THE LAZY DFA: "DOES THIS LINE MATCH?"
+//------------------------------------------------------------------------------
+
+class Lazy_dfa {
+    const Program& prog;
+    map<vector<int>, int> ids;        // Set of NFA states -> DFA state
+    vector<vector<int>> sets;
+    vector<array<int, 256>> next;     // -1: not computed yet
+    vector<char> accepting;
+    vector<int> start_set;
+    size_t max_states;
+
+    int add(vector<int> s) {
+        auto p = ids.find(s);
+        if (p != ids.end()) return p->second;
+        int id = int(sets.size());
+        bool acc = false;
+        for (int pc : s) if (prog.code[pc].op == Inst::match) acc = true;
+        ids.emplace(s, id);
+        sets.push_back(move(s));
+        next.emplace_back();
+        next.back().fill(-1);
+        accepting.push_back(acc);
+        return id;
+    }
+
+    void flush() {
+        ids.clear();
+        sets.clear();
+        next.clear();
+        accepting.clear();
+        ++flushes;
+    }
+
+public:
+    size_t flushes = 0;
+
+    Lazy_dfa(const Program& p, size_t limit = 2000) : prog{p}, max_states{limit} {
+        vector<char> seen(prog.code.size());
+        closure(prog, 0, start_set, seen);
+        sort(start_set.begin(), start_set.end());
+        add(start_set);   // State 0
+    }
+
+    // Searching for a match anywhere: a new attempt starts at every position
+    int step(int s, unsigned char c) {
+        int t = next[s][c];
+        if (t >= 0) return t;
+        vector<char> seen(prog.code.size());
+        vector<int> out;
+        for (int pc : sets[s]) {
+            const Inst& in = prog.code[pc];
+            if (in.op == Inst::chars && prog.sets[in.x][c]) closure(prog, pc + 1, out, seen);
+        }
+        for (int pc : start_set)
+            if (!seen[pc]) { seen[pc] = 1; out.push_back(pc); }
+        sort(out.begin(), out.end());
+        if (sets.size() >= max_states) {   // Cache full: start over
+            flush();
+            add(start_set);
+            return add(move(out));         // s is gone: don't record the transition
+        }
+        t = add(move(out));
+        next[s][c] = t;
+        return t;
+    }
+
+    bool accepts(int s) const { return accepting[s]; }
+    size_t states() const { return sets.size(); }
+
+    bool contains_match(const char* s, size_t n) {
+        int st = 0;
+        if (accepts(st)) return true;
+        for (size_t i = 0; i < n; ++i) {
+            st = step(st, s[i]);
+            if (accepts(st)) return true;
+        }
+        return false;
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.18.4 FINDING THE MATCHES IN A LINE
+//------------------------------------------------------------------------------
+
+/* * Run the reversed program from the end of the line to its start. A thread
+ * started at position e stands for "a match ending at e". When two threads
+ * reach the same NFA state, only the one with the larger e (the longer
+ * match) is kept; what happens further left does not depend on e. When a
+ * thread reaches 'match' at position s, longest[s] = its e.
+ * Threads are kept in order of decreasing e, so "first to arrive" is "keep".
+ */
+vector<long> longest_matches(const Program& rev, const char* s, size_t n) {
+    vector<long> longest(n + 1, -1);
+    vector<pair<int, long>> cur, nxt;   // (pc, end)
+    vector<char> seen(rev.code.size());
+    vector<int> cl;
+
+    auto add = [&](vector<pair<int, long>>& list, int pc, long end) {
+        cl.clear();
+        closure(rev, pc, cl, seen);
+        for (int q : cl) list.push_back({q, end});
+    };
+
+    for (long pos = long(n); pos >= 0; --pos) {
+        // New thread: a match may end here (smallest end so far: goes last)
+        add(cur, 0, pos);
+        for (auto [pc, end] : cur)
+            if (rev.code[pc].op == Inst::match) longest[pos] = max(longest[pos], end);
+        if (pos == 0) break;
+
+        fill(seen.begin(), seen.end(), 0);
+        nxt.clear();
+        unsigned char c = s[pos - 1];
+        for (auto [pc, end] : cur) {
+            const Inst& in = rev.code[pc];
+            if (in.op == Inst::chars && rev.sets[in.x][c]) add(nxt, pc + 1, end);
+        }
+        swap(cur, nxt);
+    }
+    return longest;
+}
+
+//------------------------------------------------------------------------------
+// 19.18.5 THE REGEX AND THE DOCUMENT SEARCH
+//------------------------------------------------------------------------------
+
+class Regex {
+    Program fwd;
+    Program rev;
+    Lazy_dfa dfa;   // Filled in by searches: see for_each_match()
+
+public:
+    explicit Regex(string_view pattern)
+        : Regex{Regex_parser{pattern}} { }
+
+    explicit Regex(const Regex_parser& parsed)
+        : fwd{compile(parsed, false)}, rev{compile(parsed, true)}, dfa{fwd} { }
+
+    Regex(const Regex&) = delete;   // dfa refers to fwd
+    Regex& operator=(const Regex&) = delete;
+
+    // Call f(col, len) for each leftmost-longest, non-overlapping match in [s:s+n).
+    // Not const: the search adds states to the DFA cache (or flushes it), so
+    // two threads must not search with the same Regex. Give each its own.
+    template<typename F>
+    void for_each_match(const char* s, size_t n, F f) {
+        if (!dfa.contains_match(s, n)) return;   // The common case: one cheap pass
+        vector<long> longest = longest_matches(rev, s, n);
+        for (size_t i = 0; i <= n; ) {
+            if (longest[i] < 0) { ++i; continue; }
+            size_t len = longest[i] - i;
+            f(i, len);
+            i += max<size_t>(len, 1);   // An empty match: move on one character
+        }
+    }
+
+    size_t dfa_states() const { return dfa.states(); }
+    size_t dfa_flushes() const { return dfa.flushes; }
+};
+
+using Line = vector<char>;
+
+struct Document {
+    list<Line> line;
+    Document() { line.push_back(Line{}); }
+};
+
+struct Match {
+    int line;
+    size_t col;
+    size_t len;
+};
+
+vector<Match> find_all(const Document& d, Regex& re) {
+    vector<Match> res;
+    int ln = 0;
+    for (const Line& line : d.line) {
+        re.for_each_match(line.data(), line.size(), [&](size_t col, size_t len) {
+            res.push_back(Match{ln, col, len});
+        });
+        ++ln;
+    }
+    return res;
+}
+
+//------------------------------------------------------------------------------
+// 19.18.6 BENCHMARK: AGAINST std::regex
+//------------------------------------------------------------------------------
+
+void benchmark() {
+    Document d;
+    mt19937 rng{4};
+    size_t size = 0;
+    for (int i = 0; size < 16'000'000; ++i) {
+        string s = "2024-01-01 12:00:" + to_string(10 + i % 50) + " INFO request " + to_string(i) + " served";
+        if (rng() % 100 == 0) s += " by user" + to_string(rng() % 1000) + "@example.com";
+        s += "\n";
+        size += s.size();
+        d.line.insert(prev(d.line.end()), Line(s.begin(), s.end()));
+    }
+    const double mb = size / 1e6;
+    const string pattern = "[a-z]+[0-9]*@[a-z]+\\.(com|org)";
+
+    auto t0 = steady_clock::now();
+    Regex re{pattern};
+    size_t hits = find_all(d, re).size();
+    auto t1 = steady_clock::now();
+
+    // std::regex needs one contiguous string: copy the document first
+    string all;
+    for (const Line& ln : d.line) all.append(ln.begin(), ln.end());
+    std::regex sre{pattern};
+    size_t shits = distance(sregex_iterator{all.begin(), all.end(), sre}, sregex_iterator{});
+    auto t2 = steady_clock::now();
+
+    cout << "Regex:      " << mb / duration<double>(t1 - t0).count() << " MB/s, " << hits << " matches, "
+         << re.dfa_states() << " DFA states\n";
+    cout << "std::regex: " << mb / duration<double>(t2 - t1).count() << " MB/s, " << shits << " matches\n";
+
+    // Backtracking's worst case: no 'b', so every way of splitting the a's is tried
+    for (int n : {16, 22, 26}) {
+        string a(n, 'a');
+        Regex bad{"(a|aa)*b"};
+        std::regex sbad{"(a|aa)*b"};
+        auto t3 = steady_clock::now();
+        size_t m1 = 0;
+        bad.for_each_match(a.data(), a.size(), [&](size_t, size_t) { ++m1; });
+        auto t4 = steady_clock::now();
+        bool m2 = regex_search(a, sbad);
+        auto t5 = steady_clock::now();
+        cout << "(a|aa)*b on " << n << " a's: Regex " << duration<double, micro>(t4 - t3).count()
+             << "us (" << m1 << "), std::regex " << duration<double, micro>(t5 - t4).count()
+             << "us (" << m2 << ")\n";
+    }
+}
+
+int main() {
+    Document d;
+    for (string s : {"mail bjarne@example.com or\n", "support@isocpp.org, not @nobody\n", "colour color colr\n"})
+        d.line.insert(prev(d.line.end()), Line(s.begin(), s.end()));
+
+    for (string p : {"[a-z]+@[a-z]+\\.(com|org)", "colou?r", "[^ ,\\n]+"}) {
+        Regex re{p};
+        cout << p << ":";
+        for (const Match& m : find_all(d, re)) {
+            auto ln = next(d.line.begin(), m.line);
+            cout << " \"" << string(ln->begin() + m.col, ln->begin() + m.col + m.len) << "\"";
+        }
+        cout << "\n";
+    }
+
+    try {
+        Regex bad{"(unclosed"};
+    } catch (runtime_error& e) {
+        cout << e.what() << "\n";
+    }
+
+    benchmark();
+    return 0;
+}
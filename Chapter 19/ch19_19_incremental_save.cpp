@@ -0,0 +1,223 @@
+/**
+ * SECTION 19.19: SAVING ONLY WHAT CHANGED
+ * --- THE PROBLEM ---
+ * Saving the 19.5 Document writes every line to the file, so fixing one typo
+ * in a 2GB log means writing 2GB.
+ * --- THE SOLUTION ---
+ * [1] Remember where each line starts in the file as last saved (offsets).
+ * [2] Track the FIRST DIRTY LINE: the first line that was edited, inserted
+ * or erased since the last save. Every line before it is still byte for byte
+ * what the file holds, at the same offset.
+ * [3] save() writes from that line's offset to the end, then truncates the
+ * file to its new length. An edit near the end of a large file costs a tiny
+ * write; an edit in the middle, half a file.
+ * [4] The price: the file is changed IN PLACE, so a crash in the middle of a
+ * save leaves a mixture of old and new. The full save writes a new file and
+ * renames it over the old one, which is all-or-nothing.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <list>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+#include <chrono>
+
+#include <fcntl.h>      // POSIX: open
+#include <unistd.h>     // POSIX: pwrite, ftruncate, fdatasync, close
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.19.1 THE DOCUMENT, WITH DIRTY TRACKING
+//------------------------------------------------------------------------------
+
+using Line = vector<char>;   // Each line keeps its '\n', except the last
+
+class Document {
+    list<Line> lines;
+    vector<list<Line>::iterator> by_number;   // Line n in O(1)
+    string file;              // The file that offsets describe; "" if none yet
+    vector<size_t> offsets;   // Where lines [0:first_dirty] start in that file
+    // Lines [first_dirty:line_count()) differ from the file (if first_dirty ==
+    // line_count(), lines were only erased at the end: the file is too long).
+    // first_dirty == line_count() + 1 means the file is up to date
+    size_t first_dirty;
+
+    void touch(size_t n) { first_dirty = min(first_dirty, n); }
+
+public:
+    Document() {
+        lines.push_back(Line{});
+        by_number.push_back(lines.begin());
+        offsets = {0};
+        first_dirty = 0;   // Never saved: everything differs from no file at all
+    }
+
+    size_t line_count() const { return by_number.size(); }
+    const Line& line(size_t n) const { return *by_number[n]; }
+    bool modified() const { return first_dirty <= line_count(); }
+
+    // Changing line n makes it (and everything after it) unsaved
+    Line& edit(size_t n) {
+        touch(n);
+        return *by_number[n];
+    }
+
+    void insert_line(size_t n, string_view s) {
+        touch(n);
+        auto p = lines.insert(n < line_count() ? by_number[n] : lines.end(), Line(s.begin(), s.end()));
+        by_number.insert(by_number.begin() + n, p);
+    }
+
+    void erase_line(size_t n) {
+        touch(n);
+        lines.erase(by_number[n]);
+        by_number.erase(by_number.begin() + n);
+    }
+
+    void load(const string& path) {
+        ifstream is{path, ios::binary};
+        if (!is) throw runtime_error{"Document: cannot open " + path};
+        lines.assign(1, Line{});
+        offsets = {0};
+        size_t off = 0;
+        for (char c; is.get(c); ) {
+            lines.back().push_back(c);
+            ++off;
+            if (c == '\n') {
+                lines.push_back(Line{});
+                offsets.push_back(off);
+            }
+        }
+        offsets.push_back(off);   // The end of the file
+        by_number.clear();
+        for (auto p = lines.begin(); p != lines.end(); ++p) by_number.push_back(p);
+        file = path;
+        first_dirty = line_count() + 1;
+    }
+
+    // The 19.5 way: write everything to a new file, then rename it into place
+    void save_all(const string& path, bool durable = true) {
+        string tmp = path + ".tmp";
+        int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw runtime_error{"Document: cannot create " + tmp};
+        string buf;
+        size_t off = 0;
+        bool ok = true;
+        offsets.assign(1, 0);
+        for (auto p = lines.begin(); p != lines.end() && ok; ++p) {
+            buf.append(p->begin(), p->end());
+            offsets.push_back(offsets.back() + p->size());
+            if (buf.size() >= (1 << 20) || next(p) == lines.end()) {
+                ok = pwrite(fd, buf.data(), buf.size(), off) == ssize_t(buf.size());
+                off += buf.size();
+                buf.clear();
+            }
+        }
+        if (ok && durable) ok = fdatasync(fd) == 0;
+        close(fd);
+        if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+            throw runtime_error{"Document: cannot save " + path};
+        file = path;
+        first_dirty = line_count() + 1;
+    }
+
+    // Rewrite only from the first dirty line on; return the bytes written.
+    // The offsets only describe the file we loaded or last saved: any other
+    // path gets a full save
+    size_t save(const string& path, bool durable = true) {
+        if (path != file) {
+            save_all(path, durable);
+            return offsets.back();
+        }
+        if (!modified()) return 0;
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+        if (fd < 0) throw runtime_error{"Document: cannot open " + path};
+
+        size_t start = offsets[first_dirty];
+        size_t off = start;
+        offsets.resize(first_dirty + 1);
+        string buf;
+        bool ok = true;
+        for (size_t n = first_dirty; n < line_count() && ok; ++n) {
+            const Line& ln = *by_number[n];
+            buf.append(ln.begin(), ln.end());
+            offsets.push_back(offsets.back() + ln.size());
+            if (buf.size() >= (1 << 20) || n + 1 == line_count()) {
+                ok = pwrite(fd, buf.data(), buf.size(), off) == ssize_t(buf.size());
+                off += buf.size();
+                buf.clear();
+            }
+        }
+        if (ok) ok = ftruncate(fd, off) == 0;   // The document may have shrunk
+        if (ok && durable) ok = fdatasync(fd) == 0;
+        close(fd);
+        if (!ok) throw runtime_error{"Document: cannot save " + path};
+        first_dirty = line_count() + 1;
+        return off - start;
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.19.2 BENCHMARK: SAVE LATENCY AFTER A SMALL EDIT
+//------------------------------------------------------------------------------
+
+string file_text(const string& path) {
+    ifstream is{path, ios::binary};
+    return string{istreambuf_iterator<char>{is}, istreambuf_iterator<char>{}};
+}
+
+void benchmark() {
+    string path = (filesystem::temp_directory_path() / "ch19_19_big.log").string();
+    Document d;
+    for (int i = 0; d.line_count() < 4'000'000; ++i)   // About 220MB
+        d.insert_line(d.line_count() - 1, "2024-01-01 12:00:00 INFO request " + to_string(i) + " served in 3ms\n");
+
+    auto t0 = steady_clock::now();
+    d.save_all(path);
+    auto t1 = steady_clock::now();
+    double full = duration<double, milli>(t1 - t0).count();
+    cout << "full save:  " << full << "ms (" << filesystem::file_size(path) / 1'000'000 << "MB)\n";
+
+    for (double where : {0.999, 0.9, 0.5, 0.0}) {
+        size_t n = size_t(where * (d.line_count() - 1));
+        Line& ln = d.edit(n);
+        ln.insert(ln.begin(), '*');
+        auto t2 = steady_clock::now();
+        size_t bytes = d.save(path);
+        auto t3 = steady_clock::now();
+        cout << "edit at " << where * 100 << "%: save " << duration<double, milli>(t3 - t2).count()
+             << "ms, " << bytes / 1000 << "KB written\n";
+    }
+    filesystem::remove(path);
+}
+
+int main() {
+    string path = (filesystem::temp_directory_path() / "ch19_19_demo.txt").string();
+    Document d;
+    d.edit(0).assign({'o', 'n', 'e', '\n'});
+    d.insert_line(1, "two\n");
+    d.insert_line(2, "three\n");
+    d.save_all(path);
+
+    d.load(path);
+    Line& ln = d.edit(2);
+    ln.insert(ln.begin(), {'3', ' '});   // Only "3 three\n" (and what follows) is rewritten
+    d.erase_line(3);                     // The empty last line
+    cout << "bytes written: " << d.save(path) << "\n" << file_text(path);
+
+    string copy = path + ".copy";   // Not the file the offsets describe: a full save
+    cout << "bytes written to a new file: " << d.save(copy) << ", same text: "
+         << (file_text(copy) == file_text(path)) << "\n";
+    filesystem::remove(path);
+    filesystem::remove(copy);
+
+    benchmark();
+    return 0;
+}
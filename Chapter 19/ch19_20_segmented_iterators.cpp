@@ -0,0 +1,278 @@
+/**
+ * SECTION 19.20: SEGMENTED ITERATORS
+ * --- THE PROBLEM ---
+ * The Text_iterator of 19.5 makes the Document look like one sequence of
+ * characters, which is what lets find(), count() and copy() work on it. But
+ * every ++ asks "end of this line?" and maybe hops to the next list node, so
+ * the compiler can't vectorize the loop, and memchr/memcpy can't be used.
+ * --- THE SOLUTION ---
+ * [1] The Document IS a sequence of contiguous pieces: its lines. Let
+ * algorithms see that. segments(first, last) yields one span<char> per line
+ * (cut to [first:last) at the two ends).
+ * [2] Segment-aware algorithms: an outer loop over the segments, an inner
+ * loop over a plain contiguous span. The inner loop is memchr, memcpy,
+ * memcmp or a loop the compiler vectorizes.
+ * [3] Overloads: find(), count(), copy(), equal() and match() taking
+ * Text_iterators are picked over the std:: templates by overload resolution,
+ * so calling code doesn't change. The character-at-a-time Text_iterator is
+ * still there for everything else.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <string>
+#include <span>
+#include <iterator>
+#include <algorithm>
+#include <cstring>    // For memchr, memcmp
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.20.1 THE 19.5 DOCUMENT AND TEXT ITERATOR
+//------------------------------------------------------------------------------
+
+using Line = vector<char>;
+
+struct Document {
+    list<Line> line;
+    Document() { line.push_back(Line{}); }   // Always ends with an empty line
+    struct Text_iterator begin();
+    struct Text_iterator end();
+    struct Segment_range segments();
+};
+
+struct Text_iterator {
+    // So that std:: algorithms accept it
+    using iterator_category = forward_iterator_tag;
+    using value_type = char;
+    using difference_type = ptrdiff_t;
+    using pointer = char*;
+    using reference = char&;
+
+    list<Line>::iterator ln;
+    Line::iterator pos;
+
+    Text_iterator() = default;
+    Text_iterator(list<Line>::iterator ll, Line::iterator pp) : ln{ll}, pos{pp} { }
+
+    char& operator*() const { return *pos; }
+
+    Text_iterator& operator++() {
+        ++pos;
+        if (pos == ln->end()) {
+            ++ln;
+            pos = ln->begin();
+        }
+        return *this;
+    }
+    Text_iterator operator++(int) { Text_iterator t = *this; ++*this; return t; }
+
+    bool operator==(const Text_iterator& other) const { return ln == other.ln && pos == other.pos; }
+    bool operator!=(const Text_iterator& other) const { return !(*this == other); }
+};
+
+Text_iterator Document::begin() { return Text_iterator{line.begin(), line.begin()->begin()}; }
+Text_iterator Document::end() {
+    auto last = line.end();
+    --last;
+    return Text_iterator{last, last->end()};
+}
+
+// Add text, splitting it into lines that keep their '\n'
+void append_text(Document& d, const string& text) {
+    auto last = prev(d.line.end());
+    for (char c : text) {
+        last->push_back(c);
+        if (c == '\n') last = d.line.insert(d.line.end(), Line{});
+    }
+    if (!last->empty()) d.line.push_back(Line{});
+}
+
+//------------------------------------------------------------------------------
+// 19.20.2 THE SEGMENTS OF [first:last)
+//------------------------------------------------------------------------------
+
+class Segment_iterator {
+    list<Line>::iterator ln;
+    Line::iterator from;     // Where this segment starts (first.pos for the first one)
+    Text_iterator last;
+    bool done;
+
+public:
+    Segment_iterator(Text_iterator first, Text_iterator l, bool d)
+        : ln{first.ln}, from{first.pos}, last{l}, done{d} { }
+
+    span<char> operator*() const {
+        auto to = ln == last.ln ? last.pos : ln->end();
+        return {from, to};
+    }
+
+    // Where the segment starts, as a Text_iterator (to report what we found)
+    Text_iterator at(size_t i) const { return Text_iterator{ln, from + i}; }
+
+    Segment_iterator& operator++() {
+        if (ln == last.ln) {
+            done = true;
+        } else {
+            ++ln;
+            from = ln->begin();
+        }
+        return *this;
+    }
+
+    bool operator==(const Segment_iterator& other) const {
+        return done == other.done && (done || (ln == other.ln && from == other.from));
+    }
+    bool operator!=(const Segment_iterator& other) const { return !(*this == other); }
+};
+
+struct Segment_range {
+    Text_iterator first, last;
+    Segment_iterator begin() const { return Segment_iterator{first, last, first == last}; }
+    Segment_iterator end() const { return Segment_iterator{last, last, true}; }
+};
+
+Segment_range segments(Text_iterator first, Text_iterator last) { return Segment_range{first, last}; }
+Segment_range Document::segments() { return ::segments(begin(), end()); }
+
+//------------------------------------------------------------------------------
+// 19.20.3 SEGMENT-AWARE ALGORITHMS
+//------------------------------------------------------------------------------
+
+Text_iterator find(Text_iterator first, Text_iterator last, char c) {
+    auto r = segments(first, last);
+    for (auto p = r.begin(); p != r.end(); ++p) {
+        span<char> s = *p;
+        if (s.empty()) continue;
+        if (auto q = static_cast<char*>(memchr(s.data(), c, s.size()))) return p.at(q - s.data());
+    }
+    return last;
+}
+
+ptrdiff_t count(Text_iterator first, Text_iterator last, char c) {
+    ptrdiff_t n = 0;
+    for (span<char> s : segments(first, last))
+        n += std::count(s.begin(), s.end(), c);   // A plain loop over chars: vectorized
+    return n;
+}
+
+template<typename Out>
+Out copy(Text_iterator first, Text_iterator last, Out out) {
+    for (span<char> s : segments(first, last))
+        out = std::copy(s.begin(), s.end(), out);   // memmove when Out is char*
+    return out;
+}
+
+// Do [first1:last1) and [first2:last2) hold the same characters? The two
+// sequences are usually cut into segments in different places.
+bool equal(Text_iterator first1, Text_iterator last1, Text_iterator first2, Text_iterator last2) {
+    auto r1 = segments(first1, last1);
+    auto r2 = segments(first2, last2);
+    auto p1 = r1.begin();
+    auto p2 = r2.begin();
+    span<char> s1, s2;
+    while (true) {
+        for (; s1.empty() && p1 != r1.end(); ++p1) s1 = *p1;
+        for (; s2.empty() && p2 != r2.end(); ++p2) s2 = *p2;
+        if (s1.empty() || s2.empty()) return s1.empty() && s2.empty();
+        size_t n = min(s1.size(), s2.size());
+        if (memcmp(s1.data(), s2.data(), n) != 0) return false;
+        s1 = s1.subspan(n);
+        s2 = s2.subspan(n);
+    }
+}
+
+// Does the text at p start with s? (19.5's match(), a segment at a time)
+bool match(Text_iterator p, Text_iterator last, const string& s) {
+    size_t done = 0;
+    for (span<char> seg : segments(p, last)) {
+        size_t n = min(seg.size(), s.size() - done);
+        if (n && memcmp(seg.data(), s.data() + done, n) != 0) return false;   // An empty line's data() may be null
+        done += n;
+        if (done == s.size()) return true;
+    }
+    return done == s.size();
+}
+
+// 19.5's find_txt(), unchanged but for using the segmented find() and match()
+Text_iterator find_txt(Text_iterator first, Text_iterator last, const string& s) {
+    if (s.empty()) return last;
+    for (auto p = first; (p = find(p, last, s[0])) != last; ++p)
+        if (match(p, last, s)) return p;
+    return last;
+}
+
+//------------------------------------------------------------------------------
+// 19.20.4 BENCHMARK: CHARACTER AT A TIME VS SEGMENT AT A TIME
+//------------------------------------------------------------------------------
+
+// The 19.5 versions, for comparison
+bool char_match(Text_iterator p, Text_iterator last, const string& s) {
+    for (char c : s) {
+        if (p == last || *p != c) return false;
+        ++p;
+    }
+    return true;
+}
+
+Text_iterator char_find_txt(Text_iterator first, Text_iterator last, const string& s) {
+    if (s.empty()) return last;
+    for (auto p = first; p != last; ++p)
+        if (*p == s[0] && char_match(p, last, s)) return p;
+    return last;
+}
+
+template<typename F>
+double mb_per_s(double mb, F f) {
+    auto t0 = steady_clock::now();
+    f();
+    return mb / duration<double>(steady_clock::now() - t0).count();
+}
+
+void benchmark() {
+    string text;
+    for (int i = 0; text.size() < 64'000'000; ++i)
+        text += "The quick brown fox jumps over the lazy dog, line " + to_string(i) + "\n";
+    Document d, d2;
+    append_text(d, text);
+    append_text(d2, text);
+    const double mb = text.size() / 1e6;
+    vector<char> buf(text.size());
+    long r1 = 0, r2 = 0;
+
+    cout << "                char at a time   segment at a time (MB/s)\n";
+    cout << "find:           " << mb_per_s(mb, [&] { r1 += std::find(d.begin(), d.end(), '#') == d.end(); })
+         << "\t\t" << mb_per_s(mb, [&] { r2 += find(d.begin(), d.end(), '#') == d.end(); }) << "\n";
+    cout << "count:          " << mb_per_s(mb, [&] { r1 += std::count(d.begin(), d.end(), 'o'); })
+         << "\t\t" << mb_per_s(mb, [&] { r2 += count(d.begin(), d.end(), 'o'); }) << "\n";
+    cout << "copy:           " << mb_per_s(mb, [&] { r1 += *(std::copy(d.begin(), d.end(), buf.data()) - 1); })
+         << "\t\t" << mb_per_s(mb, [&] { r2 += *(copy(d.begin(), d.end(), buf.data()) - 1); }) << "\n";
+    cout << "equal:          " << mb_per_s(mb, [&] { r1 += std::equal(d.begin(), d.end(), d2.begin(), d2.end()); })
+         << "\t\t" << mb_per_s(mb, [&] { r2 += equal(d.begin(), d.end(), d2.begin(), d2.end()); }) << "\n";
+    cout << "find_txt:       " << mb_per_s(mb, [&] { r1 += char_find_txt(d.begin(), d.end(), "lazy cat") == d.end(); })
+         << "\t\t" << mb_per_s(mb, [&] { r2 += find_txt(d.begin(), d.end(), "lazy cat") == d.end(); }) << "\n";
+    cout << "same results: " << (r1 == r2) << "\n";
+}
+
+int main() {
+    Document d;
+    append_text(d, "Some text\nwith a secret\nover three lines\n");
+
+    cout << "segment sizes:";
+    for (span<char> s : d.segments()) cout << ' ' << s.size();
+    cout << "\n";
+
+    auto p = find_txt(d.begin(), d.end(), "secret\nover");   // Across a line end
+    cout << "found: " << (p != d.end()) << ", e's: " << count(d.begin(), d.end(), 'e') << "\n";
+
+    string copied;
+    copy(p, d.end(), back_inserter(copied));   // Any output iterator still works
+    cout << "copied: \"" << copied << "\"\n";
+
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,304 @@
+/**
+ * SECTION 19.7: UNROLLED LINKED LISTS
+ * --- THE CONCEPT ---
+ * A Link<T> (19.3) holds ONE element, so walking a list means one pointer
+ * chase (and often one cache miss) per element. An unrolled list's nodes
+ * each hold a small ARRAY of elements:
+ * 1. Traversal: inside a node we step through an array, like a vector;
+ * we only chase a pointer once every K elements.
+ * 2. Insert/erase: still local. We shift at most K elements inside one node.
+ * A full node is split in two. A node that drops below 1/4 full takes
+ * elements from a neighbour, or merges with it if both fit in one node, so
+ * every node but the last (which push_back is filling) is at least 1/4 full.
+ * * --- THE ITERATOR CONTRACT ---
+ * An iterator is (node, index). Insert/erase only invalidates iterators into
+ * the node(s) they touch (the node itself and any node it splits into,
+ * merges with or takes elements from); iterators into every other node
+ * remain valid, as with list.
+ * The iterator is bidirectional, so high() and the chapter 21 algorithms work.
+ */
+
+#include <iostream>
+#include <list>
+#include <array>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.7.1 THE UNROLLED LIST
+//------------------------------------------------------------------------------
+
+/* * Node_bytes picks how big a node is (64 bytes to 1KB is the useful range).
+ * For simplicity T must be default constructible: the array is always full
+ * of T objects, only the first 'count' of which are elements.
+ */
+template<typename T, int Node_bytes = 256>
+class Unrolled_list {
+    static constexpr int K = max<int>(4, (Node_bytes - 2 * sizeof(void*) - sizeof(int)) / sizeof(T));
+
+    struct Node {
+        Node* prev = nullptr;
+        Node* succ = nullptr;
+        int count = 0;
+        array<T, K> elem;
+    };
+
+    Node* first = nullptr;
+    Node* last = nullptr;
+    int sz = 0;
+
+    // Move the upper half of n into a new node after n
+    Node* split(Node* n) {
+        Node* m = new Node;
+        int half = n->count / 2;
+        move(n->elem.begin() + half, n->elem.begin() + n->count, m->elem.begin());
+        m->count = n->count - half;
+        n->count = half;
+        m->prev = n;
+        m->succ = n->succ;
+        if (n->succ) n->succ->prev = m;
+        else last = m;
+        n->succ = m;
+        return m;
+    }
+
+    // n has fallen below K/4 full: merge it with a neighbour, or share the
+    // neighbour's elements evenly (both then end up over K/2 full).
+    // (n, i) is updated to keep pointing at the same place.
+    void rebalance(Node*& n, int& i) {
+        if (Node* s = n->succ) {
+            if (n->count + s->count <= K) {   // s joins n
+                move(s->elem.begin(), s->elem.begin() + s->count, n->elem.begin() + n->count);
+                n->count += s->count;
+                unlink(s);
+            } else {                           // n takes the front of s
+                int k = (s->count - n->count) / 2;
+                move(s->elem.begin(), s->elem.begin() + k, n->elem.begin() + n->count);
+                move(s->elem.begin() + k, s->elem.begin() + s->count, s->elem.begin());
+                n->count += k;
+                s->count -= k;
+            }
+        } else if (Node* p = n->prev) {        // n is the last node: use the one before
+            if (p->count + n->count <= K) {   // n joins p
+                move(n->elem.begin(), n->elem.begin() + n->count, p->elem.begin() + p->count);
+                i += p->count;
+                p->count += n->count;
+                unlink(n);
+                n = p;
+            } else {                           // n takes the back of p
+                int k = (p->count - n->count) / 2;
+                move_backward(n->elem.begin(), n->elem.begin() + n->count, n->elem.begin() + n->count + k);
+                move(p->elem.begin() + p->count - k, p->elem.begin() + p->count, n->elem.begin());
+                p->count -= k;
+                n->count += k;
+                i += k;
+            }
+        }
+    }
+
+    void unlink(Node* n) {
+        if (n->prev) n->prev->succ = n->succ;
+        else first = n->succ;
+        if (n->succ) n->succ->prev = n->prev;
+        else last = n->prev;
+        delete n;
+    }
+
+public:
+    class iterator {
+        Node* n;
+        int i;
+        Node* const* lastp;   // The list's 'last', so that --end() works
+        friend class Unrolled_list;
+    public:
+        using iterator_category = bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator(Node* nn = nullptr, int ii = 0, Node* const* lp = nullptr)
+            : n{nn}, i{ii}, lastp{lp} { }
+
+        T& operator*() const { return n->elem[i]; }
+        T* operator->() const { return &n->elem[i]; }
+
+        // Step within the node's array; hop to the next node only at its end
+        iterator& operator++() {
+            if (++i == n->count) { n = n->succ; i = 0; }
+            return *this;
+        }
+        iterator operator++(int) { iterator t = *this; ++*this; return t; }
+
+        iterator& operator--() {   // Not valid on begin()
+            if (i == 0) { n = n ? n->prev : *lastp; i = n->count; }
+            --i;
+            return *this;
+        }
+        iterator operator--(int) { iterator t = *this; --*this; return t; }
+
+        bool operator==(const iterator& b) const { return n == b.n && i == b.i; }
+        bool operator!=(const iterator& b) const { return !(*this == b); }
+    };
+
+    Unrolled_list() = default;
+    Unrolled_list(const Unrolled_list&) = delete;
+    Unrolled_list& operator=(const Unrolled_list&) = delete;
+
+    ~Unrolled_list() {
+        while (first) {
+            Node* n = first->succ;
+            delete first;
+            first = n;
+        }
+    }
+
+    iterator begin() { return {first, 0, &last}; }
+    iterator end() { return {nullptr, 0, &last}; }
+    int size() const { return sz; }
+    static constexpr int node_capacity() { return K; }
+
+    //--- INSERT: shift within one node, split it if it is full ---
+
+    iterator insert(iterator pos, const T& val) {
+        Node* n = pos.n;
+        int i = pos.i;
+        if (!n) {                         // Inserting at end(): use the last node
+            if (!last || last->count == K) {
+                Node* m = new Node;
+                m->prev = last;
+                if (last) last->succ = m;
+                else first = m;
+                last = m;
+            }
+            n = last;
+            i = n->count;
+        }
+        if (n->count == K) {              // Full: split and pick the right half
+            Node* m = split(n);
+            if (i > n->count) { i -= n->count; n = m; }
+        }
+        move_backward(n->elem.begin() + i, n->elem.begin() + n->count,
+                      n->elem.begin() + n->count + 1);
+        n->elem[i] = val;
+        ++n->count;
+        ++sz;
+        return {n, i, &last};
+    }
+
+    void push_back(const T& val) { insert(end(), val); }
+    void push_front(const T& val) { insert(begin(), val); }
+
+    //--- ERASE: shift within one node, rebalance with a neighbour if it gets thin ---
+
+    iterator erase(iterator pos) {
+        Node* n = pos.n;
+        int i = pos.i;
+        move(n->elem.begin() + i + 1, n->elem.begin() + n->count, n->elem.begin() + i);
+        --n->count;
+        --sz;
+
+        if (n->count == 0) {
+            Node* next = n->succ;
+            unlink(n);
+            return {next, 0, &last};
+        }
+        if (n->count < K / 4) rebalance(n, i);
+        if (i == n->count) return {n->succ, 0, &last};
+        return {n, i, &last};
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.7.2 HIGH() AND THE ALGORITHMS STILL WORK
+//------------------------------------------------------------------------------
+
+template<typename Iter>
+Iter high(Iter first, Iter last) {
+    Iter high_it = first;
+    for (Iter p = first; p != last; ++p) {
+        if (*high_it < *p) high_it = p;
+    }
+    return high_it;
+}
+
+void list_demo() {
+    Unrolled_list<int> lst;
+    lst.push_back(10);
+    lst.push_back(50);
+    lst.push_back(20);
+    lst.push_front(100);
+
+    auto p = high(lst.begin(), lst.end());
+    cout << "The highest value in the list is: " << *p << "\n";
+
+    // Chapter 21 algorithms
+    cout << "sum: " << accumulate(lst.begin(), lst.end(), 0)
+         << ", count of 20: " << count(lst.begin(), lst.end(), 20)
+         << ", 50 found: " << (find(lst.begin(), lst.end(), 50) != lst.end()) << "\n";
+
+    // Insert and erase in the middle; watch split and merge happen
+    for (int i = 1000; i < 2000; ++i) lst.insert(find(lst.begin(), lst.end(), 20), i);
+    while (lst.size() > 4) lst.erase(lst.begin());
+    cout << "after churn:";
+    for (int x : lst) cout << ' ' << x;
+    cout << ", last: " << *--lst.end() << "\n";
+}
+
+//------------------------------------------------------------------------------
+// 19.7.3 BENCHMARK: TRAVERSAL BANDWIDTH
+//------------------------------------------------------------------------------
+
+template<typename C>
+void time_high(const string& label, C& c, int n) {
+    const int reps = 10;
+    auto t0 = steady_clock::now();
+    long long s = 0;
+    for (int r = 0; r < reps; ++r) s += *high(c.begin(), c.end());
+    auto t1 = steady_clock::now();
+    double secs = duration<double>(t1 - t0).count();
+    double gb = double(n) * reps * sizeof(int) / 1e9;
+    cout << label << ": " << gb / secs << " GB/s (" << s / reps << ")\n";
+}
+
+void traversal_benchmark() {
+    const int n = 5'000'000;
+    mt19937 rng{7};
+
+    // A list<int> whose nodes are scattered around memory, as after a long
+    // life of inserts and erases: splice the nodes into shuffled order
+    list<int> lst;
+    for (int i = 0; i < n; ++i) lst.push_back(i);
+    vector<list<int>::iterator> its;
+    for (auto p = lst.begin(); p != lst.end(); ++p) its.push_back(p);
+    shuffle(its.begin(), its.end(), rng);
+    list<int> scattered;
+    for (auto p : its) scattered.splice(scattered.end(), lst, p);
+
+    Unrolled_list<int, 64> small;
+    Unrolled_list<int, 256> medium;
+    Unrolled_list<int, 1024> large;
+    for (int x : scattered) {
+        small.push_back(x);
+        medium.push_back(x);
+        large.push_back(x);
+    }
+
+    time_high("list<int> (scattered)     ", scattered, n);
+    time_high("Unrolled_list 64B nodes   ", small, n);
+    time_high("Unrolled_list 256B nodes  ", medium, n);
+    time_high("Unrolled_list 1KB nodes   ", large, n);
+}
+
+int main() {
+    list_demo();
+    traversal_benchmark();
+    return 0;
+}
@@ -0,0 +1,266 @@
+/**
+ * SECTION 19.8: INDEXED SKIP LISTS
+ * --- THE CONCEPT ---
+ * erase_line() in 19.5 must advance() n times through list<Line> to find
+ * line n: every "go to line N" is O(N). A vector would give O(1) access but
+ * O(N) insert. A SKIP LIST gives O(log N) for both:
+ * 1. Levels: every node is on level 0 (an ordinary linked list). About half
+ * the nodes are also on level 1, a quarter on level 2, and so on. Higher
+ * levels are "express lanes" that skip over many nodes at once.
+ * 2. Widths: each forward pointer remembers how many level-0 steps it
+ * skips. Adding widths as we go tells us our position, so we can find
+ * element i by taking express lanes and dropping down: O(log N) expected.
+ * 3. Bidirectional: level 0 also has prev pointers, so the iterator can go
+ * both ways, just like list<Line>'s.
+ * * --- THE TRADE-OFF ---
+ * Each node carries a few extra pointers (2 on average), and heights are
+ * random, so the O(log N) is "expected," not guaranteed.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <string>
+#include <random>
+#include <bit>        // For std::countr_zero
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.8.1 THE SKIP LIST
+//------------------------------------------------------------------------------
+
+template<typename T>
+class Skip_list {
+    static constexpr int max_level = 32;
+
+    struct Node;
+    struct Level {
+        Node* next;
+        int width;   // Number of level-0 steps from this node to 'next'
+    };
+
+    // head and nil carry no value, so they are plain Nodes without the T part
+    struct Node {
+        Node* prev = nullptr;   // Level 0 only
+        vector<Level> lv;
+        explicit Node(int height) : lv(height) { }
+        virtual ~Node() = default;
+    };
+    struct Value_node : Node {
+        T val;
+        Value_node(int height, const T& v) : Node{height}, val{v} { }
+    };
+
+    Node head{max_level};   // Position -1
+    Node nil{0};            // Position size(): the end
+    int sz = 0;
+    mt19937 rng{12345};
+
+    // Level k with probability 1/2^(k+1), from the trailing zeros of one random word
+    int random_height() {
+        return min(max_level, countr_zero(static_cast<unsigned>(rng()) | (1u << (max_level - 1))) + 1);
+    }
+
+    // For each level, the last node before position i, and that node's position
+    void find_before(int i, Node* update[], int pos[]) {
+        Node* x = &head;
+        int p = -1;
+        for (int k = max_level - 1; k >= 0; --k) {
+            while (p + x->lv[k].width < i) {   // nil is at position size() >= i: never passed
+                p += x->lv[k].width;
+                x = x->lv[k].next;
+            }
+            update[k] = x;
+            pos[k] = p;
+        }
+    }
+
+    Value_node* node_at(int i) {
+        if (i < 0 || sz <= i) throw out_of_range{"Skip_list::at()"};
+        Node* x = &head;
+        int p = -1;
+        for (int k = max_level - 1; k >= 0; --k)
+            while (p + x->lv[k].width <= i) {
+                p += x->lv[k].width;
+                x = x->lv[k].next;
+            }
+        return static_cast<Value_node*>(x);
+    }
+
+public:
+    class iterator {
+        Node* curr;
+        friend class Skip_list;
+    public:
+        using iterator_category = bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        explicit iterator(Node* p = nullptr) : curr{p} { }
+        T& operator*() const { return static_cast<Value_node*>(curr)->val; }
+        T* operator->() const { return &static_cast<Value_node*>(curr)->val; }
+        iterator& operator++() { curr = curr->lv[0].next; return *this; }
+        iterator& operator--() { curr = curr->prev; return *this; }
+        iterator operator++(int) { iterator t = *this; ++*this; return t; }
+        iterator operator--(int) { iterator t = *this; --*this; return t; }
+        bool operator==(const iterator& b) const { return curr == b.curr; }
+        bool operator!=(const iterator& b) const { return curr != b.curr; }
+    };
+
+    Skip_list() {
+        for (Level& l : head.lv) l = Level{&nil, 1};
+        nil.prev = &head;
+    }
+    Skip_list(const Skip_list&) = delete;
+    Skip_list& operator=(const Skip_list&) = delete;
+
+    ~Skip_list() {
+        Node* x = head.lv[0].next;
+        while (x != &nil) {
+            Node* next = x->lv[0].next;
+            delete x;
+            x = next;
+        }
+    }
+
+    int size() const { return sz; }
+    iterator begin() { return iterator{head.lv[0].next}; }
+    iterator end() { return iterator{&nil}; }
+
+    T& at(int i) { return node_at(i)->val; }
+    T& operator[](int i) { return node_at(i)->val; }
+
+    //--- INSERT val AS ELEMENT i (0 <= i <= size()) ---
+
+    iterator insert(int i, const T& val) {
+        if (i < 0 || sz < i) throw out_of_range{"Skip_list::insert()"};
+        Node* update[max_level];
+        int pos[max_level];
+        find_before(i, update, pos);
+
+        int h = random_height();
+        Value_node* n = new Value_node{h, val};
+        for (int k = 0; k < max_level; ++k) {
+            Level& before = update[k]->lv[k];
+            if (k < h) {
+                // before.next was at pos[k] + width; after insert it is one further on
+                n->lv[k] = Level{before.next, pos[k] + before.width + 1 - i};
+                before = Level{n, i - pos[k]};
+            } else {
+                ++before.width;   // The lane now skips over one more node
+            }
+        }
+        n->prev = update[0];
+        n->lv[0].next->prev = n;
+        ++sz;
+        return iterator{n};
+    }
+
+    void push_back(const T& val) { insert(sz, val); }
+
+    //--- ERASE ELEMENT i ---
+
+    void erase(int i) {
+        if (i < 0 || sz <= i) throw out_of_range{"Skip_list::erase()"};
+        Node* update[max_level];
+        int pos[max_level];
+        find_before(i, update, pos);
+
+        Node* x = update[0]->lv[0].next;
+        int h = static_cast<int>(x->lv.size());
+        for (int k = 0; k < max_level; ++k) {
+            Level& before = update[k]->lv[k];
+            if (k < h) before = Level{x->lv[k].next, before.width + x->lv[k].width - 1};
+            else --before.width;
+        }
+        x->lv[0].next->prev = update[0];
+        delete x;
+        --sz;
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.8.2 THE DOCUMENT, WITH O(log N) LINE ACCESS
+//------------------------------------------------------------------------------
+
+using Line = vector<char>;
+
+struct Document {
+    Skip_list<Line> line;
+    Document() { line.push_back(Line{}); }   // Start with one empty line
+};
+
+// Same interface as 19.5, but no advance(): O(log N) instead of O(N)
+void erase_line(Document& d, int n) {
+    if (n < 0 || n >= d.line.size()) return;
+    d.line.erase(n);
+}
+
+void insert_line(Document& d, int n, const Line& ln) {
+    if (n < 0 || n > d.line.size()) return;
+    d.line.insert(n, ln);
+}
+
+//------------------------------------------------------------------------------
+// 19.8.3 BENCHMARK: RANDOM LINE EDITS
+//------------------------------------------------------------------------------
+
+/* * The target workload is a 10M-line document; lines = 1M keeps the demo
+ * quick and small. The list<Line> run does far fewer edits because each
+ * one costs O(N); compare the per-edit times.
+ */
+void edit_benchmark() {
+    const int lines = 1'000'000;
+    const int skip_edits = 200'000;
+    const int list_edits = 200;
+    const Line text(40, 'x');
+    mt19937 rng{1};
+
+    Document doc;
+    list<Line> plain(1);
+    for (int i = 0; i < lines; ++i) {
+        doc.line.push_back(text);
+        plain.push_back(text);
+    }
+
+    auto t0 = steady_clock::now();
+    for (int e = 0; e < skip_edits; ++e) {
+        int n = rng() % doc.line.size();
+        if (e % 2) erase_line(doc, n);
+        else insert_line(doc, n, text);
+    }
+    auto t1 = steady_clock::now();
+    for (int e = 0; e < list_edits; ++e) {
+        auto p = plain.begin();
+        advance(p, rng() % plain.size());
+        if (e % 2) plain.erase(p);
+        else plain.insert(p, text);
+    }
+    auto t2 = steady_clock::now();
+
+    cout << "Skip_list<Line>: " << duration<double, micro>(t1 - t0).count() / skip_edits << "us per edit\n";
+    cout << "list<Line>:      " << duration<double, micro>(t2 - t1).count() / list_edits << "us per edit\n";
+}
+
+int main() {
+    Skip_list<string> s;
+    for (string w : {"alpha", "beta", "delta"}) s.push_back(w);
+    s.insert(2, "gamma");          // Insert at index
+    s.erase(0);                    // Erase at index
+    cout << "s[1] = " << s[1] << "; forward:";
+    for (const string& w : s) cout << ' ' << w;
+    cout << "; backward:";
+    for (auto p = s.end(); p != s.begin();) cout << ' ' << *--p;
+    cout << "\n";
+
+    edit_benchmark();
+    return 0;
+}
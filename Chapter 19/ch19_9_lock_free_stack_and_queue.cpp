@@ -0,0 +1,407 @@
+/**
+ * SECTION 19.9: LOCK-FREE STACKS AND QUEUES
+ * --- THE CONCEPT ---
+ * Links (19.3) are also the building block of concurrent containers. Instead
+ * of one mutex around a whole list, we change ONE pointer at a time with an
+ * atomic compare-and-swap (CAS): "if head is still h, make it n."
+ * 1. Treiber stack: push and pop both CAS the head pointer.
+ * 2. Michael-Scott queue: a dummy head link plus a tail pointer; enqueue CASes
+ * the last link's succ, dequeue CASes the head.
+ * * --- THE HARD PART: WHEN CAN A LINK BE DELETED? ---
+ * After pop unlinks a Link, another thread may still be looking at it. If we
+ * delete (or reuse) it at once, that thread reads freed memory, or its CAS
+ * succeeds against a recycled Link with the same address (the "ABA" problem).
+ * 3. Epoch-based reclamation: every thread announces the global "epoch" when
+ * it starts an operation. An unlinked Link is "retired" with the current
+ * epoch and recycled only after the epoch has advanced twice, by which time
+ * no thread can still hold a pointer to it.
+ * 4. Node pool: recycled Links go to a per-thread pool instead of delete, so
+ * steady-state push/pop never calls new.
+ */
+
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <list>
+#include <cstdint>
+#include <chrono>
+#include <stdexcept>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 19.9.1 THE CONCURRENT LINK
+//------------------------------------------------------------------------------
+
+/* * Like Link<T> from 19.3, but a lock-free chain only needs succ, and
+ * succ must be atomic because several threads read and CAS it.
+ */
+template<typename T>
+struct Link {
+    T val;
+    atomic<Link*> succ{nullptr};
+};
+
+//------------------------------------------------------------------------------
+// 19.9.2 THE NODE POOL
+//------------------------------------------------------------------------------
+
+/* * Each thread keeps a small free list. Producers allocate and consumers
+ * recycle, so full batches are handed between threads through a shared
+ * list; that mutex is taken once per 'batch' Links, not once per operation.
+ */
+template<typename N>
+class Node_pool {
+    static constexpr size_t batch = 256;
+
+    static mutex m;
+    static vector<vector<N*>> shared;
+
+    struct Local {
+        vector<N*> free;
+        ~Local() {   // Thread exit: give our Links to the others
+            if (free.empty()) return;
+            lock_guard<mutex> lck{m};
+            shared.push_back(move(free));
+        }
+    };
+    static Local& local() { thread_local Local l; return l; }
+
+public:
+    static N* get() {
+        vector<N*>& f = local().free;
+        if (f.empty()) {
+            lock_guard<mutex> lck{m};
+            if (!shared.empty()) {
+                f = move(shared.back());
+                shared.pop_back();
+            }
+        }
+        if (f.empty()) return new N;
+        N* n = f.back();
+        f.pop_back();
+        return n;
+    }
+
+    static void put(N* n) {
+        vector<N*>& f = local().free;
+        f.push_back(n);
+        if (f.size() >= 2 * batch) {   // Keep one batch, share the other
+            vector<N*> give(f.end() - batch, f.end());
+            f.resize(f.size() - batch);
+            lock_guard<mutex> lck{m};
+            shared.push_back(move(give));
+        }
+    }
+
+    // Call once all threads are done
+    static void release_all() {
+        lock_guard<mutex> lck{m};
+        for (auto& v : shared)
+            for (N* n : v) delete n;
+        shared.clear();
+        for (N* n : local().free) delete n;
+        local().free.clear();
+    }
+};
+
+template<typename N> mutex Node_pool<N>::m;
+template<typename N> vector<vector<N*>> Node_pool<N>::shared;
+
+//------------------------------------------------------------------------------
+// 19.9.3 EPOCH-BASED RECLAMATION
+//------------------------------------------------------------------------------
+
+namespace Epoch {
+    constexpr int max_threads = 128;
+
+    struct Record {
+        atomic<uint64_t> epoch{0};
+        atomic<bool> active{false};
+        atomic<bool> used{false};
+    };
+
+    atomic<uint64_t> global{2};
+    Record records[max_threads];
+
+    struct Retired {
+        uint64_t epoch;
+        void* p;
+        void (*recycle)(void*);
+    };
+
+    mutex orphans_m;
+    vector<Retired> orphans;   // Left behind by threads that have exited
+
+    struct Thread_state {
+        Record* rec = nullptr;
+        vector<Retired> limbo;
+        int since_collect = 0;
+
+        Thread_state() {
+            for (Record& r : records) {
+                bool expected = false;
+                if (r.used.compare_exchange_strong(expected, true)) { rec = &r; return; }
+            }
+            throw runtime_error{"Epoch: too many threads"};
+        }
+
+        ~Thread_state() {
+            {
+                lock_guard<mutex> lck{orphans_m};
+                orphans.insert(orphans.end(), limbo.begin(), limbo.end());
+            }
+            rec->active = false;
+            rec->used = false;
+        }
+    };
+
+    Thread_state& me() { thread_local Thread_state s; return s; }
+
+    // Advance the epoch if every active thread has seen the current one
+    void try_advance() {
+        uint64_t e = global.load();
+        for (Record& r : records)
+            if (r.active.load() && r.epoch.load() != e) return;
+        global.compare_exchange_strong(e, e + 1);
+    }
+
+    // Recycle whatever was retired at least two epochs ago
+    void collect(vector<Retired>& v) {
+        uint64_t e = global.load();
+        size_t keep = 0;
+        for (Retired& r : v) {
+            if (r.epoch + 2 <= e) r.recycle(r.p);
+            else v[keep++] = r;
+        }
+        v.resize(keep);
+    }
+
+    void collect() {
+        Thread_state& s = me();
+        try_advance();
+        collect(s.limbo);
+        unique_lock<mutex> lck{orphans_m, try_to_lock};
+        if (lck) collect(orphans);
+    }
+
+    // RAII: while a Guard exists, Links we can reach won't be recycled
+    struct Guard {
+        Record* rec;
+        Guard() : rec{me().rec} {
+            rec->epoch.store(global.load());
+            rec->active.store(true);
+            atomic_thread_fence(memory_order_seq_cst);
+            rec->epoch.store(global.load());   // Re-read: we may have raced an advance
+        }
+        ~Guard() { rec->active.store(false); }
+    };
+
+    template<typename N>
+    void retire(N* n) {
+        Thread_state& s = me();
+        s.limbo.push_back({global.load(), n, [](void* p) { Node_pool<N>::put(static_cast<N*>(p)); }});
+        if (++s.since_collect == 64) {
+            s.since_collect = 0;
+            collect();
+        }
+    }
+
+    // Call once all threads are done: everything retired is now unreachable
+    void drain() {
+        global += 2;
+        collect(me().limbo);
+        lock_guard<mutex> lck{orphans_m};
+        collect(orphans);
+    }
+}
+
+//------------------------------------------------------------------------------
+// 19.9.4 THE TREIBER STACK
+//------------------------------------------------------------------------------
+
+template<typename T>
+class Lock_free_stack {
+    using Node = Link<T>;
+    atomic<Node*> head{nullptr};
+
+public:
+    Lock_free_stack() = default;
+    Lock_free_stack(const Lock_free_stack&) = delete;
+    Lock_free_stack& operator=(const Lock_free_stack&) = delete;
+
+    ~Lock_free_stack() {   // No other thread may be using the stack now
+        for (Node* p = head.load(); p; ) {
+            Node* next = p->succ.load();
+            delete p;
+            p = next;
+        }
+    }
+
+    void push(const T& v) {
+        Node* n = Node_pool<Node>::get();
+        n->val = v;
+        Node* h = head.load();
+        do {
+            n->succ.store(h);
+        } while (!head.compare_exchange_weak(h, n));   // On failure h is reloaded
+    }
+
+    bool pop(T& v) {
+        Epoch::Guard g;   // h can't be recycled (so no ABA) while we look at it
+        Node* h = head.load();
+        while (h && !head.compare_exchange_weak(h, h->succ.load())) { }
+        if (!h) return false;
+        v = h->val;
+        Epoch::retire(h);
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.9.5 THE MICHAEL-SCOTT QUEUE
+//------------------------------------------------------------------------------
+
+template<typename T>
+class Lock_free_queue {
+    using Node = Link<T>;
+    atomic<Node*> head;   // Dummy link: the first element is head->succ
+    atomic<Node*> tail;
+
+public:
+    Lock_free_queue() {
+        Node* dummy = new Node;
+        head.store(dummy);
+        tail.store(dummy);
+    }
+    Lock_free_queue(const Lock_free_queue&) = delete;
+    Lock_free_queue& operator=(const Lock_free_queue&) = delete;
+
+    ~Lock_free_queue() {
+        for (Node* p = head.load(); p; ) {
+            Node* next = p->succ.load();
+            delete p;
+            p = next;
+        }
+    }
+
+    void enqueue(const T& v) {
+        Node* n = Node_pool<Node>::get();
+        n->val = v;
+        n->succ.store(nullptr);
+        Epoch::Guard g;
+        for (;;) {
+            Node* t = tail.load();
+            Node* next = t->succ.load();
+            if (t != tail.load()) continue;
+            if (next == nullptr) {
+                if (t->succ.compare_exchange_weak(next, n)) {
+                    tail.compare_exchange_strong(t, n);   // May fail: someone helped
+                    return;
+                }
+            } else {
+                tail.compare_exchange_strong(t, next);    // Help a lagging tail along
+            }
+        }
+    }
+
+    bool dequeue(T& v) {
+        Epoch::Guard g;
+        for (;;) {
+            Node* h = head.load();
+            Node* t = tail.load();
+            Node* next = h->succ.load();
+            if (h != head.load()) continue;
+            if (next == nullptr) return false;            // Empty
+            if (h == t) {
+                tail.compare_exchange_strong(t, next);    // Tail lags: help
+                continue;
+            }
+            T tmp = next->val;                            // Read before the CAS
+            if (head.compare_exchange_weak(h, next)) {
+                v = tmp;
+                Epoch::retire(h);                         // next is the new dummy
+                return true;
+            }
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+// 19.9.6 BENCHMARK: 1 TO 64 THREADS VS MUTEX + LIST
+//------------------------------------------------------------------------------
+
+/* * Every thread alternates producing and consuming: push 'burst' items,
+ * then pop 'burst' items (whatever is there).
+ */
+template<typename Push, typename Pop>
+long long contention_run(int nthreads, int ops, Push push, Pop pop) {
+    atomic<long long> popped{0};
+    vector<thread> ts;
+    auto t0 = steady_clock::now();
+    for (int t = 0; t < nthreads; ++t)
+        ts.emplace_back([&, t] {
+            const int burst = 16;
+            long long mine = 0;
+            int v;
+            for (int i = 0; i < ops / nthreads; i += burst) {
+                for (int j = 0; j < burst; ++j) push(t * ops + i + j);
+                for (int j = 0; j < burst; ++j) if (pop(v)) ++mine;
+            }
+            popped += mine;
+        });
+    for (auto& t : ts) t.join();
+    return duration_cast<microseconds>(steady_clock::now() - t0).count();
+}
+
+void contention_benchmark() {
+    const int ops = 1'000'000;
+    cout << "threads  mutex+list(us)  Treiber stack(us)  MS queue(us)\n";
+    for (int n = 1; n <= 64; n *= 2) {
+        list<int> lst;
+        mutex m;
+        long long d1 = contention_run(n, ops,
+            [&](int v) { lock_guard<mutex> lck{m}; lst.push_back(v); },
+            [&](int& v) {
+                lock_guard<mutex> lck{m};
+                if (lst.empty()) return false;
+                v = lst.front();
+                lst.pop_front();
+                return true;
+            });
+
+        Lock_free_stack<int> st;
+        long long d2 = contention_run(n, ops,
+            [&](int v) { st.push(v); }, [&](int& v) { return st.pop(v); });
+
+        Lock_free_queue<int> q;
+        long long d3 = contention_run(n, ops,
+            [&](int v) { q.enqueue(v); }, [&](int& v) { return q.dequeue(v); });
+
+        cout << n << "\t " << d1 << "\t\t " << d2 << "\t\t    " << d3 << "\n";
+    }
+}
+
+int main() {
+    Lock_free_queue<int> q;
+    Lock_free_stack<int> s;
+
+    thread producer{[&] { for (int i = 1; i <= 5; ++i) { q.enqueue(i); s.push(i); } }};
+    producer.join();
+
+    int v;
+    cout << "queue (FIFO):";
+    while (q.dequeue(v)) cout << ' ' << v;
+    cout << "\nstack (LIFO):";
+    while (s.pop(v)) cout << ' ' << v;
+    cout << "\n";
+
+    contention_benchmark();
+
+    Epoch::drain();   // All threads are done: recycle everything retired
+    Node_pool<Link<int>>::release_all();
+    return 0;
+}
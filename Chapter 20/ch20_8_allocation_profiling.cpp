@@ -0,0 +1,356 @@
+/**
+ * SECTION 20.8: ALLOCATION PROFILING
+ * --- THE GOAL ---
+ * Timing (20.4) tells us HOW LONG a container took; it does not tell us WHY.
+ * Very often the answer is "it called new a million times." This section is
+ * a standalone profiling demo: it counts the free-store traffic of cut-down
+ * copies of the containers from chapters 15-20 (each section is its own
+ * program, so the hook below is not wired into the other sections' demos).
+ * 1. Operator new hook: replace the global operator new/delete so EVERY
+ * allocation (Vector, Link, vector<char> lines, map nodes) is recorded.
+ * 2. Tracking_allocator: an allocator (like the A in Vector_rep, 18.4) that
+ * records into a named profile explicitly, without the global hook.
+ * 3. Tags: a Tag_scope names "who is allocating right now"; each tag keeps
+ * count, bytes, live and peak-live bytes and a size-class histogram.
+ * 4. Report: print the profile next to the timing of every benchmark here.
+ */
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <chrono>
+#include <cstdlib>  // For malloc and free
+#include <cstring>  // For strcmp
+#include <new>
+#include <algorithm>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 20.8.1 PROFILES
+//------------------------------------------------------------------------------
+
+/* * The profile table must not allocate (it is used from inside operator
+ * new!), so it is a fixed array rather than a map<string, Profile>.
+ */
+namespace Alloc_profile {
+    constexpr int max_tags = 32;
+    constexpr int size_classes = 10;  // <=16, <=32, ... <=4096, bigger
+
+    struct Profile {
+        const char* tag = nullptr;
+        long long count = 0;     // Number of allocations
+        long long bytes = 0;     // Total bytes ever allocated
+        long long live = 0;      // Bytes currently allocated
+        long long peak = 0;      // Highest value of 'live'
+        long long hist[size_classes] = {};
+    };
+
+    Profile profiles[max_tags] = {{"untagged"}};
+    int ntags = 1;
+    int current = 0;             // Index of the tag being charged
+    bool enabled = false;        // Off until the first reset() or Tag_scope
+
+    int size_class(size_t n) {
+        int c = 0;
+        for (size_t limit = 16; c < size_classes - 1 && n > limit; limit *= 2) ++c;
+        return c;
+    }
+
+    // Compare the text: two spellings of the same literal may not share storage
+    int tag_index(const char* tag) {
+        for (int i = 0; i < ntags; ++i)
+            if (strcmp(profiles[i].tag, tag) == 0) return i;
+        if (ntags == max_tags) return 0;   // Table full: charge "untagged"
+        profiles[ntags].tag = tag;
+        return ntags++;
+    }
+
+    void record_alloc(int t, size_t n) {
+        Profile& p = profiles[t];
+        ++p.count;
+        p.bytes += n;
+        p.live += n;
+        p.peak = max(p.peak, p.live);
+        ++p.hist[size_class(n)];
+    }
+
+    void record_free(int t, size_t n) { profiles[t].live -= n; }
+
+    // Start counting 'tag' (and, from now on, everything new allocates) afresh.
+    // Blocks it paid for may still be live; they stay counted, or freeing
+    // them would drive 'live' negative
+    void reset(const char* tag) {
+        int t = tag_index(tag);
+        long long live = profiles[t].live;
+        profiles[t] = Profile{profiles[t].tag};
+        profiles[t].live = profiles[t].peak = live;
+        enabled = true;
+    }
+
+    void print(const char* tag) {
+        const Profile& p = profiles[tag_index(tag)];
+        cout << "  [" << p.tag << "] allocs " << p.count << ", bytes " << p.bytes
+             << ", peak live " << p.peak << ", live " << p.live << "\n  sizes:";
+        size_t limit = 16;
+        for (int c = 0; c < size_classes; ++c, limit *= 2) {
+            if (p.hist[c] == 0) continue;
+            if (c == size_classes - 1) cout << " >" << limit / 2 << ":" << p.hist[c];
+            else cout << " <=" << limit << ":" << p.hist[c];
+        }
+        cout << "\n";
+    }
+
+    // RAII: charge allocations in this scope to 'tag' (like a lock_guard)
+    struct Tag_scope {
+        int saved;
+        explicit Tag_scope(const char* tag) : saved{current} {
+            current = tag_index(tag);
+            enabled = true;
+        }
+        ~Tag_scope() { current = saved; }
+    };
+}
+
+//------------------------------------------------------------------------------
+// 20.8.2 THE GLOBAL OPERATOR NEW HOOK
+//------------------------------------------------------------------------------
+
+/* * operator delete is not told the size, so we keep a small header in
+ * front of every block holding the size and the tag that paid for it
+ * (-1 if the block was allocated before profiling was enabled).
+ */
+struct Alloc_header {
+    size_t size;
+    int tag;
+};
+constexpr size_t header_size = alignof(max_align_t);   // Keeps the user block aligned
+
+void* operator new(size_t n) {
+    void* raw = malloc(n + header_size);
+    if (!raw) throw bad_alloc{};
+    int t = Alloc_profile::enabled ? Alloc_profile::current : -1;
+    *static_cast<Alloc_header*>(raw) = Alloc_header{n, t};
+    if (t >= 0) Alloc_profile::record_alloc(t, n);
+    return static_cast<char*>(raw) + header_size;
+}
+
+// noinline: once inlined into a container's deallocate(), GCC sees free()
+// called on a pointer that came from operator new and gives a (false)
+// -Wmismatched-new-delete warning. It has no effect on what is counted.
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+    if (!p) return;
+    void* raw = static_cast<char*>(p) - header_size;
+    const Alloc_header& h = *static_cast<Alloc_header*>(raw);
+    if (h.tag >= 0) Alloc_profile::record_free(h.tag, h.size);
+    free(raw);
+}
+
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+//------------------------------------------------------------------------------
+// 20.8.3 TRACKING_ALLOCATOR
+//------------------------------------------------------------------------------
+
+/* * For when we want one specific container profiled regardless of the
+ * current Tag_scope. It bypasses the operator new hook (malloc directly),
+ * so its allocations are not counted twice. It always records, and does
+ * not turn on the hook for the rest of the program.
+ */
+template<typename T>
+struct Tracking_allocator {
+    using value_type = T;
+    int tag;   // Looked up once, not on every allocation
+
+    explicit Tracking_allocator(const char* t) : tag{Alloc_profile::tag_index(t)} { }
+    template<typename U>
+    Tracking_allocator(const Tracking_allocator<U>& a) : tag{a.tag} { }
+
+    T* allocate(size_t n) {
+        void* p = malloc(n * sizeof(T));
+        if (!p) throw bad_alloc{};
+        Alloc_profile::record_alloc(tag, n * sizeof(T));
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t n) {
+        Alloc_profile::record_free(tag, n * sizeof(T));
+        free(p);
+    }
+
+    template<typename U>
+    bool operator==(const Tracking_allocator<U>& a) const { return tag == a.tag; }
+};
+
+//------------------------------------------------------------------------------
+// 20.8.4 TIMING PLUS PROFILE
+//------------------------------------------------------------------------------
+
+template<typename F>
+void profile(const char* tag, F f) {
+    Alloc_profile::reset(tag);
+    auto t0 = steady_clock::now();
+    {
+        Alloc_profile::Tag_scope scope{tag};
+        f();
+    }
+    auto t1 = steady_clock::now();
+    cout << tag << ": " << duration_cast<microseconds>(t1 - t0).count() << "us\n";
+    Alloc_profile::print(tag);
+}
+
+//------------------------------------------------------------------------------
+// 20.8.5 THE CHAPTER 15-20 CONTAINERS (CUT-DOWN COPIES), PROFILED
+//------------------------------------------------------------------------------
+
+// 17.9: growth by doubling
+class Vector {
+    int sz = 0;
+    double* elem = nullptr;
+    int space = 0;
+public:
+    ~Vector() { delete[] elem; }
+    void reserve(int newalloc) {
+        if (newalloc <= space) return;
+        double* p = new double[newalloc];
+        for (int i = 0; i < sz; ++i) p[i] = elem[i];
+        delete[] elem;
+        elem = p;
+        space = newalloc;
+    }
+    void push_back(double d) {
+        if (space == 0) reserve(8);
+        else if (sz == space) reserve(2 * space);
+        elem[sz++] = d;
+    }
+};
+
+// 15.7: one new per Link
+struct Link {
+    string value;
+    Link* prev;
+    Link* succ;
+    Link(const string& v, Link* p = nullptr, Link* s = nullptr)
+        : value{v}, prev{p}, succ{s} { }
+};
+
+// 19.5: one list node plus one vector<char> per line
+using Line = vector<char>;
+struct Document {
+    list<Line> line;
+};
+
+struct Fruit {
+    string name;
+    int count;
+    double unit_price;
+};
+
+struct Fruit_order {
+    bool operator()(const Fruit& a, const Fruit& b) const { return a.name < b.name; }
+};
+
+int main() {
+    const int n = 100'000;
+
+    profile("Vector push_back (17.9)", [&] {
+        Vector v;
+        for (int i = 0; i < n; ++i) v.push_back(i);
+    });
+
+    profile("Vector reserve + push_back", [&] {
+        Vector v;
+        v.reserve(n);
+        for (int i = 0; i < n; ++i) v.push_back(i);
+    });
+
+    profile("Link chain (15.7)", [&] {
+        Link* head = nullptr;
+        for (int i = 0; i < n; ++i) {
+            Link* p = new Link{"god" + to_string(i), nullptr, head};
+            if (head) head->prev = p;
+            head = p;
+        }
+        while (head) {
+            Link* next = head->succ;
+            delete head;
+            head = next;
+        }
+    });
+
+    profile("Document of 80-char lines (19.5)", [&] {
+        Document d;
+        for (int i = 0; i < n; ++i) {
+            d.line.push_back(Line{});
+            for (int c = 0; c < 80; ++c) d.line.back().push_back('x');
+        }
+    });
+
+    profile("map<string,int> (20.2)", [&] {
+        map<string, int> m;
+        for (int i = 0; i < n; ++i) m[to_string(i)] = i;
+    });
+
+    profile("set<Fruit> (20.5)", [&] {
+        set<Fruit, Fruit_order> inventory;
+        for (int i = 0; i < n; ++i) inventory.insert(Fruit{"fruit" + to_string(i), i, 0.5});
+    });
+
+    // 20.4's experiment (its phases, copied): vector vs map search, with allocation counts.
+    // Every phase of timing_experiment(), each charged to its own tag (so the
+    // timing_experiment tag itself is left with nothing)
+    const char* phases[] = {"  vector fill", "  vector find_if", "  map from vector",
+                            "  map[target]", "  map find_if"};
+    for (const char* t : phases) Alloc_profile::reset(t);
+    profile("timing_experiment (20.4)", [&] {
+        using Alloc_profile::Tag_scope;
+        const int N = 10000;
+        vector<pair<string, int>> v;
+        string target;
+        {
+            Tag_scope s{phases[0]};
+            for (int i = 0; i < N; ++i) v.push_back({to_string(i), i});
+            target = to_string(N / 2);
+        }
+        {
+            Tag_scope s{phases[1]};
+            auto pv = find_if(v.begin(), v.end(), [&](const auto& x) { return x.first == target; });
+            (void)pv;
+        }
+        map<string, int> m;
+        {
+            Tag_scope s{phases[2]};
+            m = map<string, int>(v.begin(), v.end());
+        }
+        {
+            Tag_scope s{phases[3]};
+            auto val = m[target];
+            (void)val;
+        }
+        {
+            Tag_scope s{phases[4]};
+            auto pm = find_if(m.begin(), m.end(), [&](const auto& x) { return x.first == target; });
+            (void)pm;
+        }
+    });
+    for (const char* t : phases) Alloc_profile::print(t);
+
+    // A Tracking_allocator charges its own tag no matter which scope is active
+    using Tracked_map = map<int, int, less<int>, Tracking_allocator<pair<const int, int>>>;
+    Alloc_profile::reset("Tracked map");
+    {
+        Tracked_map tm{Tracking_allocator<pair<const int, int>>{"Tracked map"}};
+        for (int i = 0; i < 1000; ++i) tm[i] = i;
+        cout << "Tracking_allocator map:\n";
+        Alloc_profile::print("Tracked map");
+    }
+
+    return 0;
+}
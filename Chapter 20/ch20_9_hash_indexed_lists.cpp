@@ -0,0 +1,260 @@
+/**
+ * SECTION 20.9: HASH-INDEXED LISTS
+ * --- THE CONCEPT ---
+ * find() on a Link chain (15.7, 15.8) compares strings all the way down the
+ * list: O(N) per lookup. An unordered_map (20.3) finds a key in O(1), but it
+ * has no order. We can have both:
+ * 1. The list keeps the order and gives O(1) insert/erase at a known Link.
+ * 2. An index, unordered_multimap<string, Entry*>, maps each value to the
+ * Entry (a Link) or Entries holding it, so find() is one hash lookup.
+ * 3. INVARIANT: every Entry in the list has exactly one entry in the index,
+ * under its current value, and vice versa. Users only ever get a const
+ * Entry*, so only insert(), erase(), set_value() and move_to() can change a
+ * value or the chain. They update both, and they refuse an Entry that
+ * belongs to another list: the invariant can't be broken from outside.
+ * 4. Moving an Entry to another Indexed_list is still O(1): two index
+ * updates and the usual pointer fiddling, no copying.
+ */
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdexcept>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 20.9.1 THE LINK (as in 15.7)
+//------------------------------------------------------------------------------
+
+struct Link {
+    string value;
+    Link* prev;
+    Link* succ;
+
+    Link(const string& v, Link* p = nullptr, Link* s = nullptr)
+        : value{v}, prev{p}, succ{s} { }
+};
+
+// The plain O(N) find from 15.7, for comparison
+Link* find(Link* p, const string& s) {
+    while (p) {
+        if (p->value == s) return p;
+        p = p->succ;
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+// 20.9.2 THE INDEXED LIST
+//------------------------------------------------------------------------------
+
+class Indexed_list;
+
+/* * A Link whose fields only Indexed_list can change. Users get const Entry*:
+ * they can read the value and walk to the next Entry, but not rewrite the
+ * value behind the index's back or rewire the chain.
+ */
+class Entry {
+    string val;
+    Entry* prev = nullptr;
+    Entry* succ = nullptr;
+    const Indexed_list* owner = nullptr;   // The list whose chain and index hold it
+
+    explicit Entry(const string& v) : val{v} { }
+    friend class Indexed_list;
+
+public:
+    const string& value() const { return val; }
+    const Entry* next() const { return succ; }
+};
+
+class Indexed_list {
+    Entry* first = nullptr;
+    Entry* last = nullptr;
+    int sz = 0;
+    unordered_multimap<string, Entry*> index;
+
+    // Every Entry we hand out was made (non-const) by us; get write access
+    // back, but only to our own. nullptr is "the end" where a position is wanted
+    Entry* mut(const Entry* p, bool end_ok = false) const {
+        if (!p && !end_ok) throw runtime_error{"Indexed_list: no Entry"};
+        if (p && p->owner != this) throw runtime_error{"Indexed_list: Entry of another list"};
+        return const_cast<Entry*>(p);
+    }
+
+    void unindex(Entry* p) {
+        auto range = index.equal_range(p->val);
+        for (auto q = range.first; q != range.second; ++q)
+            if (q->second == p) { index.erase(q); return; }
+    }
+
+    // Unhook p from the chain (it stays alive)
+    void unlink(Entry* p) {
+        if (p->prev) p->prev->succ = p->succ;
+        else first = p->succ;
+        if (p->succ) p->succ->prev = p->prev;
+        else last = p->prev;
+        p->prev = p->succ = nullptr;
+        --sz;
+    }
+
+    // Hook n in before p (p == nullptr means at the end)
+    void link_before(Entry* p, Entry* n) {
+        n->succ = p;
+        n->prev = p ? p->prev : last;
+        if (n->prev) n->prev->succ = n;
+        else first = n;
+        if (p) p->prev = n;
+        else last = n;
+        ++sz;
+    }
+
+public:
+    Indexed_list() = default;
+    Indexed_list(const Indexed_list&) = delete;
+    Indexed_list& operator=(const Indexed_list&) = delete;
+
+    ~Indexed_list() {
+        while (first) {
+            Entry* next = first->succ;
+            delete first;
+            first = next;
+        }
+    }
+
+    const Entry* begin() const { return first; }
+    int size() const { return sz; }
+
+    // Insert a new Entry holding v before p (nullptr: at the end); return it
+    const Entry* insert(const Entry* p, const string& v) {
+        Entry* pos = mut(p, true);
+        Entry* n = new Entry{v};
+        n->owner = this;
+        link_before(pos, n);
+        index.emplace(v, n);
+        return n;
+    }
+    const Entry* push_back(const string& v) { return insert(nullptr, v); }
+
+    // Erase (and delete) p; return its successor
+    const Entry* erase(const Entry* p) {
+        Entry* e = mut(p);
+        Entry* next = e->succ;
+        unindex(e);
+        unlink(e);
+        delete e;
+        return next;
+    }
+
+    // O(1): an Entry holding s (if several do, any one of them), or nullptr
+    const Entry* find(const string& s) const {
+        auto q = index.find(s);
+        return q == index.end() ? nullptr : q->second;
+    }
+
+    // Change a value: the only way to do it, so the index always follows
+    void set_value(const Entry* p, const string& v) {
+        Entry* e = mut(p);
+        unindex(e);
+        e->val = v;
+        index.emplace(v, e);
+    }
+
+    // O(1): move p from this list to before 'before' in 'to' (nullptr: at the end)
+    void move_to(const Entry* p, Indexed_list& to, const Entry* before = nullptr) {
+        Entry* e = mut(p);
+        Entry* pos = to.mut(before, true);
+        if (pos == e) throw runtime_error{"Indexed_list: can't move an Entry before itself"};
+        unindex(e);
+        unlink(e);
+        to.link_before(pos, e);
+        e->owner = &to;
+        to.index.emplace(e->val, e);
+    }
+};
+
+void print_all(const Indexed_list& lst) {
+    cout << "{ ";
+    for (const Entry* p = lst.begin(); p; p = p->next()) {
+        cout << p->value();
+        if (p->next()) cout << ", ";
+    }
+    cout << " }";
+}
+
+//------------------------------------------------------------------------------
+// 20.9.3 GODS AND PANTHEONS, INDEXED
+//------------------------------------------------------------------------------
+
+void list_demo() {
+    Indexed_list norse_gods;
+    for (string s : {"Freja", "Zeus", "Odin", "Thor"}) norse_gods.push_back(s);
+
+    Indexed_list greek_gods;
+    for (string s : {"Poseidon", "Mars", "Athena", "Hera"}) greek_gods.push_back(s);
+
+    // Fix 1: O(1) find, then correct the value (the index is kept in step)
+    if (const Entry* p = greek_gods.find("Mars")) greek_gods.set_value(p, "Ares");
+
+    // Fix 2: O(1) find, O(1) move
+    if (const Entry* p = norse_gods.find("Zeus")) norse_gods.move_to(p, greek_gods, greek_gods.begin());
+
+    cout << "Norse Gods: "; print_all(norse_gods); cout << "\n";
+    cout << "Greek Gods: "; print_all(greek_gods); cout << "\n";
+    cout << "Ares found: " << (greek_gods.find("Ares") != nullptr)
+         << ", Mars found: " << (greek_gods.find("Mars") != nullptr) << "\n";
+}
+
+//------------------------------------------------------------------------------
+// 20.9.4 BENCHMARK: LOOKUP-HEAVY TRACE
+//------------------------------------------------------------------------------
+
+void lookup_benchmark() {
+    const int n = 200'000;
+    const int indexed_lookups = 1'000'000;
+    const int plain_lookups = 500;   // Each one is O(N): keep the run short
+    mt19937 rng{3};
+
+    Indexed_list indexed;
+    Link* plain = nullptr;
+    for (int i = 0; i < n; ++i) {
+        string name = "entry" + to_string(i);
+        indexed.push_back(name);
+        Link* p = new Link{name, nullptr, plain};
+        if (plain) plain->prev = p;
+        plain = p;
+    }
+
+    vector<string> trace;
+    for (int i = 0; i < indexed_lookups; ++i) trace.push_back("entry" + to_string(rng() % n));
+
+    auto t0 = steady_clock::now();
+    int hits1 = 0;
+    for (const string& s : trace) if (indexed.find(s)) ++hits1;
+    auto t1 = steady_clock::now();
+    int hits2 = 0;
+    for (int i = 0; i < plain_lookups; ++i) if (find(plain, trace[i])) ++hits2;
+    auto t2 = steady_clock::now();
+
+    cout << "Indexed_list find: " << duration<double, nano>(t1 - t0).count() / indexed_lookups
+         << "ns per lookup (" << hits1 << " hits)\n";
+    cout << "plain Link find:   " << duration<double, nano>(t2 - t1).count() / plain_lookups
+         << "ns per lookup (" << hits2 << " hits)\n";
+
+    while (plain) {
+        Link* next = plain->succ;
+        delete plain;
+        plain = next;
+    }
+}
+
+int main() {
+    list_demo();
+    lookup_benchmark();
+    return 0;
+}
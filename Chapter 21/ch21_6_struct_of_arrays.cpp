@@ -0,0 +1,226 @@
+/**
+ * SECTION 21.6: STRUCT OF ARRAYS
+ * --- THE CONCEPT ---
+ * vector<Record> is an "array of structs" (AoS): unit_price and units sit
+ * side by side in memory. A scan that only needs ONE field still pulls the
+ * other fields (and for Fruit, a whole string) through the cache.
+ * A "struct of arrays" (SoA) keeps each member in its own vector:
+ * 1. Column access: col<I>() is a plain contiguous range, so accumulate
+ * and inner_product run over exactly the bytes they need.
+ * 2. Row access: a Row proxy still lets us look at "record i" as a whole,
+ * and the row iterator works with for-loops and algorithms.
+ * * --- THE TRADE-OFF ---
+ * Adding/removing a row touches every column, and a row is no longer one
+ * object in memory. SoA wins when scans are column-at-a-time.
+ */
+
+#include <iostream>
+#include <vector>
+#include <tuple>
+#include <span>
+#include <numeric>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <string>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//------------------------------------------------------------------------------
+// 21.6.1 THE SOA CONTAINER
+//------------------------------------------------------------------------------
+
+template<typename... Ts>
+class Soa {
+    tuple<vector<Ts>...> cols;
+
+public:
+    //--- ROW PROXY: "record i", made of references into each column ---
+
+    template<typename S>
+    class Row_ref {
+        S* s;
+        size_t i;
+    public:
+        Row_ref(S* ss, size_t ii) : s{ss}, i{ii} { }
+        template<auto I> auto& get() const { return std::get<size_t(I)>(s->cols)[i]; }
+        tuple<const Ts&...> values() const {
+            return apply([this](const auto&... c) { return tuple<const Ts&...>{c[i]...}; }, s->cols);
+        }
+    };
+
+    //--- ROW ITERATOR ---
+
+    template<typename S>
+    class Row_iterator {
+        S* s;
+        size_t i;
+    public:
+        // *p is a proxy, not a Row&, so to the standard library this is
+        // an input iterator: enough for find_if(), count_if(), for_each() ...
+        using iterator_category = input_iterator_tag;
+        using value_type = Row_ref<S>;
+        using difference_type = ptrdiff_t;
+        using reference = Row_ref<S>;
+        using pointer = void;
+
+        Row_iterator(S* ss, size_t ii) : s{ss}, i{ii} { }
+        Row_ref<S> operator*() const { return {s, i}; }
+        Row_iterator& operator++() { ++i; return *this; }
+        Row_iterator operator++(int) { Row_iterator t = *this; ++i; return t; }
+        Row_iterator& operator--() { --i; return *this; }
+        Row_iterator operator--(int) { Row_iterator t = *this; --i; return t; }
+        bool operator==(const Row_iterator& b) const { return i == b.i; }
+        bool operator!=(const Row_iterator& b) const { return i != b.i; }
+    };
+
+    using iterator = Row_iterator<Soa>;
+    using const_iterator = Row_iterator<const Soa>;
+
+    //--- SIZE AND GROWTH ---
+
+    size_t size() const { return std::get<0>(cols).size(); }
+
+    void reserve(size_t n) { apply([n](auto&... c) { (c.reserve(n), ...); }, cols); }
+
+    void push_back(const Ts&... vals) {
+        apply([&](auto&... c) { (c.push_back(vals), ...); }, cols);
+    }
+
+    void pop_back() { apply([](auto&... c) { (c.pop_back(), ...); }, cols); }
+
+    //--- COLUMN ACCESS: contiguous, one member only ---
+    // I is a column number or a column enumerator (see Record_col)
+
+    template<auto I> span<tuple_element_t<size_t(I), tuple<Ts...>>> col() { return std::get<size_t(I)>(cols); }
+    template<auto I> span<const tuple_element_t<size_t(I), tuple<Ts...>>> col() const {
+        return std::get<size_t(I)>(cols);
+    }
+
+    //--- ROW ACCESS ---
+
+    Row_ref<Soa> operator[](size_t i) { return {this, i}; }
+    Row_ref<const Soa> operator[](size_t i) const { return {this, i}; }
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, size()}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, size()}; }
+};
+
+//------------------------------------------------------------------------------
+// 21.6.2 RECORD AND FRUIT AS SOA
+//------------------------------------------------------------------------------
+
+struct Record {
+    double unit_price;
+    int units;
+};
+
+double price_sum(double v, const Record& r) {
+    return v + (r.unit_price * r.units);
+}
+
+// Column numbers, so we can write col<Record_col::unit_price>() instead of col<0>()
+enum class Record_col { unit_price, units };
+using Record_soa = Soa<double, int>;
+
+struct Fruit {
+    string name;
+    int count;
+    double unit_price;
+};
+
+enum class Fruit_col { name, count, price };
+using Fruit_soa = Soa<string, int, double>;
+
+// Inventory valuation over two columns: sum of price[i] * units[i]
+double value(const Record_soa& inv) {
+    auto price = inv.col<Record_col::unit_price>();
+    auto count = inv.col<Record_col::units>();
+    return inner_product(price.begin(), price.end(), count.begin(), 0.0);
+}
+
+//------------------------------------------------------------------------------
+// 21.6.3 BENCHMARK: AOS VS SOA INVENTORY VALUATION
+//------------------------------------------------------------------------------
+
+template<typename F>
+double time_it(const string& label, F f) {
+    auto t0 = steady_clock::now();
+    double r = f();
+    auto t1 = steady_clock::now();
+    cout << label << ": " << duration_cast<microseconds>(t1 - t0).count() << "us (" << r << ")\n";
+    return r;
+}
+
+void benchmark() {
+    const int n = 5'000'000;
+
+    vector<Record> rec_aos;
+    Record_soa rec_soa;
+    vector<Fruit> fruit_aos;
+    Fruit_soa fruit_soa;
+    rec_aos.reserve(n);
+    rec_soa.reserve(n);
+    fruit_aos.reserve(n);
+    fruit_soa.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        double p = (i % 100) * 0.25;
+        int u = i % 13;
+        rec_aos.push_back({p, u});
+        rec_soa.push_back(p, u);
+        fruit_aos.push_back({"fruit", u, p});
+        fruit_soa.push_back("fruit", u, p);
+    }
+
+    time_it("Record AoS accumulate(price_sum)", [&] {
+        return accumulate(rec_aos.begin(), rec_aos.end(), 0.0, price_sum);
+    });
+    time_it("Record SoA inner_product       ", [&] { return value(rec_soa); });
+
+    time_it("Record AoS sum of units        ", [&] {
+        return accumulate(rec_aos.begin(), rec_aos.end(), 0.0,
+                          [](double v, const Record& r) { return v + r.units; });
+    });
+    time_it("Record SoA sum of units column ", [&] {
+        auto c = rec_soa.col<Record_col::units>();
+        return accumulate(c.begin(), c.end(), 0.0);
+    });
+
+    time_it("Fruit AoS valuation            ", [&] {
+        return accumulate(fruit_aos.begin(), fruit_aos.end(), 0.0,
+                          [](double v, const Fruit& f) { return v + f.unit_price * f.count; });
+    });
+    time_it("Fruit SoA valuation            ", [&] {
+        auto p = fruit_soa.col<Fruit_col::price>();
+        auto c = fruit_soa.col<Fruit_col::count>();
+        return inner_product(p.begin(), p.end(), c.begin(), 0.0);
+    });
+}
+
+int main() {
+    Record_soa inventory;
+    inventory.push_back(9.99, 10);
+    inventory.push_back(1.50, 20);
+    inventory.push_back(5.00, 5);
+
+    cout << "Total Inventory Value: " << value(inventory) << "\n";
+
+    // Row view: the records are still there when we want them
+    for (auto r : inventory)
+        cout << r.get<Record_col::units>() << " @ " << r.get<Record_col::unit_price>() << "\n";
+
+    // Row iterators work with the standard algorithms
+    auto p = find_if(inventory.begin(), inventory.end(),
+                     [](auto r) { return r.template get<Record_col::units>() < 10; });
+    cout << "Low stock: " << (*p).get<Record_col::unit_price>() << "\n";
+
+    inventory[1].get<Record_col::units>() = 25;   // Rows are references: this writes the column
+    cout << "After restock: " << value(inventory) << "\n";
+
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,385 @@
+/**
+ * SECTION 9.12: A FAST SCANNER FOR THE STRUCTURED FILE
+ * --- THEORY PART ---
+ * [1] THE COST OF >>: The 9.9 parser is clear, but every Reading is five
+ * formatted extractions, each of which sets up a sentry, skips whitespace
+ * through the locale and checks the stream state. Every level boundary adds
+ * an unget() and a clear(). Fine for a few KB, slow for tens of GB.
+ * [2] READ BYTES, NOT VALUES: Read the file in large blocks into a buffer
+ * and look at the characters ourselves. Whitespace, '(' and '{' are single
+ * character tests; words are compared as string_views; numbers are
+ * converted with from_chars(), which does no locale lookups and allocates
+ * nothing.
+ * [3] SAME GRAMMAR, SAME RESULT: The scanner has one function per level
+ * (year, month, reading), just like the operator>>s of 9.9, fills in the
+ * same Year/Month/Day structures and applies the same checks (is_valid(),
+ * duplicate readings).
+ * [4] TOKENS AT BLOCK BOUNDARIES: A number may start at the end of one block
+ * and finish in the next. Before converting a token, the scanner makes sure
+ * all of it is in the buffer, moving the unread tail to the front and
+ * reading more if needed.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>  // For shuffle
+#include <charconv>   // For from_chars
+#include <cstring>    // For memmove
+#include <filesystem>
+#include <random>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//--- 9.12.1: The 9.9 Representation ---
+
+const int not_a_reading = -7777;
+const int not_a_month = -1;
+
+struct Day {
+    vector<double> temp = vector<double>(24, not_a_reading);
+};
+
+struct Month {
+    int month = not_a_month;           // [0:11] January is 0
+    vector<Day> day = vector<Day>(32); // [1:31] Waste day[0] for simplicity
+};
+
+struct Year {
+    int year;
+    vector<Month> month = vector<Month>(12);
+};
+
+struct Reading {
+    int day;
+    int hour;
+    double temperature;
+};
+
+void error(string s, int i = 0) { throw runtime_error(s + (i ? to_string(i) : "")); }
+
+vector<string> month_input_tbl = {
+    "jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec"
+};
+
+int month_to_int(string_view s) {
+    for (int i = 0; i < 12; ++i)
+        if (month_input_tbl[i] == s) return i;
+    return -1;
+}
+
+bool is_valid(const Reading& r) {
+    if (r.day < 1 || 31 < r.day) return false;
+    if (r.hour < 0 || 23 < r.hour) return false;
+    if (r.temperature < -200 || 200 < r.temperature) return false;
+    return true;
+}
+
+//--- 9.12.2: The Scanner: A Buffer Over an istream ---
+
+class Scanner {
+    istream& is;
+    vector<char> buf;
+    const char* p = nullptr;   // Next unread character
+    const char* e = nullptr;   // End of what has been read into buf
+    bool at_eof = false;
+
+    static bool is_space(char c) { return c == ' ' || ('\t' <= c && c <= '\r'); }
+    static bool is_number_char(char c) {
+        return ('0' <= c && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    // Keep [p:e), move it to the front of buf and read another block after it
+    bool more() {
+        if (at_eof) return false;
+        size_t keep = e - p;
+        if (keep) memmove(buf.data(), p, keep);
+        if (buf.size() - keep < block) buf.resize(keep + block);   // A huge token
+        is.read(buf.data() + keep, buf.size() - keep);
+        size_t got = is.gcount();
+        if (got == 0) at_eof = true;
+        p = buf.data();
+        e = p + keep + got;
+        return got > 0;
+    }
+
+    // The length of the run of characters from p that satisfy in(),
+    // reading more of the file until the run is complete
+    template<typename Pred>
+    size_t run(Pred in) {
+        size_t n = 0;
+        while (true) {
+            while (p + n < e && in(p[n])) ++n;
+            if (p + n < e || !more()) return n;
+        }
+    }
+
+public:
+    static constexpr size_t block = 1 << 20;
+
+    explicit Scanner(istream& s) : is{s}, buf(block) { }
+
+    // The next non-whitespace character, or EOF; doesn't consume it
+    int peek() {
+        while (true) {
+            while (p < e && is_space(*p)) ++p;
+            if (p < e) return static_cast<unsigned char>(*p);
+            if (!more()) return EOF;
+        }
+    }
+
+    // Consume c if it is the next non-whitespace character
+    bool accept(char c) {
+        if (peek() != static_cast<unsigned char>(c)) return false;
+        ++p;
+        return true;
+    }
+
+    // A whitespace-delimited word, like is >> string; valid until the next call
+    string_view word() {
+        peek();
+        size_t n = run([](char c) { return !is_space(c); });
+        string_view w{p, n};
+        p += n;
+        return w;
+    }
+
+    template<typename Number>
+    bool number(Number& x) {
+        peek();
+        size_t n = run(is_number_char);
+        auto [q, ec] = from_chars(p, p + n, x);
+        if (ec != errc{}) return false;
+        p = q;
+        return true;
+    }
+};
+
+//--- 9.12.3: Scanning the Structure, One Function per Level ---
+
+// Lowest level: Reading. False if there is no '(' (the end of a month)
+bool scan(Scanner& s, Reading& r) {
+    if (!s.accept('(')) return false;
+    if (!(s.number(r.day) && s.number(r.hour) && s.number(r.temperature) && s.accept(')')))
+        error("bad reading");
+    return true;
+}
+
+// Mid level: Month
+bool scan(Scanner& s, Month& m) {
+    if (!s.accept('{')) return false;
+    if (s.word() != "month") error("bad start of month");
+    m.month = month_to_int(s.word());
+    if (m.month == not_a_month) error("bad month name");
+
+    int duplicates = 0, invalids = 0;
+    for (Reading r; scan(s, r); ) {
+        if (is_valid(r)) {
+            if (m.day[r.day].temp[r.hour] != not_a_reading) ++duplicates;
+            m.day[r.day].temp[r.hour] = r.temperature;
+        } else ++invalids;
+    }
+    if (invalids) error("invalid readings in month", invalids);
+    if (duplicates) error("duplicate readings in month", duplicates);
+
+    if (!s.accept('}')) error("bad end of month");
+    return true;
+}
+
+// Top level: Year
+bool scan(Scanner& s, Year& y) {
+    if (!s.accept('{')) return false;
+    if (s.word() != "year" || !s.number(y.year)) error("bad start of year");
+
+    while (true) {
+        Month m; // FRESH Month for every iteration, as in 9.9
+        if (!scan(s, m)) break;
+        y.month[m.month] = move(m);
+    }
+
+    if (!s.accept('}')) error("bad end of year");
+    return true;
+}
+
+// Like the read loop of 9.9: read Years until something that isn't one
+vector<Year> scan_years(istream& is) {
+    Scanner s{is};
+    vector<Year> ys;
+    while (true) {
+        Year y;
+        if (!scan(s, y)) break;
+        ys.push_back(move(y));
+    }
+    return ys;
+}
+
+//--- 9.12.4: The 9.9 Stream Parser, for Comparison ---
+
+void end_of_loop(istream& ist, char term, const string& message) {
+    if (ist.fail()) {
+        ist.clear();
+        char ch;
+        if (ist >> ch && ch == term) return;
+        error(message);
+    }
+}
+
+istream& operator>>(istream& is, Reading& r) {
+    char ch1;
+    if (!(is >> ch1) || ch1 != '(') {
+        is.unget();
+        is.clear(ios::failbit);
+        return is;
+    }
+    char ch2;
+    if (!(is >> r.day >> r.hour >> r.temperature >> ch2) || ch2 != ')')
+        error("bad reading");
+    return is;
+}
+
+istream& operator>>(istream& is, Month& m) {
+    char ch = 0;
+    if (!(is >> ch) || ch != '{') {
+        is.unget();
+        is.clear(ios::failbit);
+        return is;
+    }
+    string month_marker, mm;
+    is >> month_marker >> mm;
+    if (!is || month_marker != "month") error("bad start of month");
+    m.month = month_to_int(mm);
+
+    int duplicates = 0, invalids = 0;
+    for (Reading r; is >> r; ) {
+        if (is_valid(r)) {
+            if (m.day[r.day].temp[r.hour] != not_a_reading) ++duplicates;
+            m.day[r.day].temp[r.hour] = r.temperature;
+        } else ++invalids;
+    }
+    if (invalids) error("invalid readings in month", invalids);
+    if (duplicates) error("duplicate readings in month", duplicates);
+
+    end_of_loop(is, '}', "bad end of month");
+    return is;
+}
+
+istream& operator>>(istream& is, Year& y) {
+    char ch = 0;
+    if (!(is >> ch) || ch != '{') {
+        is.unget();
+        is.clear(ios::failbit);
+        return is;
+    }
+    string year_marker;
+    int yy;
+    is >> year_marker >> yy;
+    if (!is || year_marker != "year") error("bad start of year");
+    y.year = yy;
+
+    while (true) {
+        Month m;
+        if (!(is >> m)) break;
+        y.month[m.month] = m;
+    }
+
+    end_of_loop(is, '}', "bad end of year");
+    return is;
+}
+
+vector<Year> read_years(istream& is) {
+    vector<Year> ys;
+    while (true) {
+        Year y;
+        if (!(is >> y)) break;
+        ys.push_back(y);
+    }
+    return ys;
+}
+
+//--- 9.12.5: Benchmark: MB/s of Both Parsers ---
+
+bool same(const vector<Year>& a, const vector<Year>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].year != b[i].year) return false;
+        for (int m = 0; m < 12; ++m) {
+            if (a[i].month[m].month != b[i].month[m].month) return false;
+            for (int d = 0; d < 32; ++d)
+                if (a[i].month[m].day[d].temp != b[i].month[m].day[d].temp) return false;
+        }
+    }
+    return true;
+}
+
+// About 100KB per year: every hour of every day, in random order
+void write_test_file(const string& path, int years) {
+    ofstream ofs{path};
+    mt19937 rng{1990};
+    vector<pair<int, int>> slots;
+    for (int d = 1; d <= 31; ++d)
+        for (int h = 0; h < 24; ++h) slots.push_back({d, h});
+    for (int y = 0; y < years; ++y) {
+        ofs << "{ year " << 1800 + y << "\n";
+        for (int m = 0; m < 12; ++m) {
+            ofs << "  { month " << month_input_tbl[m] << "\n   ";
+            shuffle(slots.begin(), slots.end(), rng);
+            for (auto [d, h] : slots)
+                ofs << " (" << d << ' ' << h << ' ' << int(rng() % 1200) / 10.0 - 40 << ')';
+            ofs << "\n  }\n";
+        }
+        ofs << "}\n";
+    }
+}
+
+void benchmark() {
+    string path = (filesystem::temp_directory_path() / "ch9_12_temps.txt").string();
+    write_test_file(path, 400);
+    double mb = filesystem::file_size(path) / 1e6;
+
+    auto t0 = steady_clock::now();
+    ifstream ifs1{path};
+    vector<Year> by_stream = read_years(ifs1);
+    auto t1 = steady_clock::now();
+    ifstream ifs2{path, ios::binary};
+    vector<Year> by_scanner = scan_years(ifs2);
+    auto t2 = steady_clock::now();
+
+    cout << mb << "MB, " << by_scanner.size() << " years\n";
+    cout << "operator>>: " << mb / duration<double>(t1 - t0).count() << " MB/s\n";
+    cout << "Scanner:    " << mb / duration<double>(t2 - t1).count() << " MB/s\n";
+    cout << "same data: " << same(by_stream, by_scanner) << "\n";
+    filesystem::remove(path);
+}
+
+int main() {
+    try {
+        istringstream iss{
+            "{ year 1990 }\n"
+            "{year 1991 { month jun }}\n"
+            "{ year 1992 { month jan ( 1 0 -4.5 ) }{month feb (1 1 68) (2 3 66.66) ( 1 0 67.2)}\n"
+            "{month dec (15 15 -9.2 ) (15 14 -8.8) (14 0 -2) }\n"
+            "}\n"};
+        vector<Year> ys = scan_years(iss);
+        cout << "Read " << ys.size() << " years of data.\n";
+        for (const Year& y : ys)
+            for (const Month& m : y.month)
+                for (int d = 1; d < 32; ++d)
+                    for (int h = 0; h < 24; ++h)
+                        if (m.day[d].temp[h] != not_a_reading)
+                            cout << y.year << ' ' << month_input_tbl[m.month] << ' ' << d << ' '
+                                 << h << ":00 " << m.day[d].temp[h] << "\n";
+
+        istringstream bad{"{ year 1990 { month feb (1 1 68) (1 1 69) } }"};
+        scan_years(bad);
+    } catch (exception& e) {
+        cerr << "Error: " << e.what() << endl;
+    }
+
+    benchmark();
+    return 0;
+}
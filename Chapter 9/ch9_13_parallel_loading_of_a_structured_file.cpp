@@ -0,0 +1,417 @@
+/**
+ * SECTION 9.13: PARALLEL LOADING OF A STRUCTURED FILE
+ * --- THEORY PART ---
+ * [1] INDEPENDENT BLOCKS: Each "{ year ... }" in the file says nothing about
+ * any other year. If we know where the years start and end, we can parse
+ * them on different threads and put the Years back in file order.
+ * [2] FINDING THE YEARS: A year is a '{' at brace depth 0 up to its matching
+ * '}'. The grammar has no strings or comments, so counting braces is enough,
+ * and it is much cheaper than parsing. Counting is parallel too: each thread
+ * counts the net '{' minus '}' of its share of the bytes; adding those up
+ * gives the depth at the start of every share, after which each thread can
+ * find the year boundaries in its share on its own.
+ * [3] THE SAME RESULT AS SEQUENTIAL PARSING: The Years come out in file
+ * order; anything at depth 0 that isn't a year ends the data, as in 9.9;
+ * and if several years are bad, the error reported is the FIRST one in the
+ * file, not whichever thread happened to fail first. Errors say which year
+ * and month they are in.
+ * [4] THE REMAINING SEQUENTIAL PART: Reading the file into memory. The
+ * parsing and brace counting scale with the number of cores.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <charconv>   // For from_chars
+#include <cstring>    // For memchr
+#include <thread>
+#include <atomic>
+#include <exception>  // For exception_ptr
+#include <filesystem>
+#include <random>
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+//--- 9.13.1: The 9.9 Representation ---
+
+const int not_a_reading = -7777;
+const int not_a_month = -1;
+
+struct Day {
+    vector<double> temp = vector<double>(24, not_a_reading);
+};
+
+struct Month {
+    int month = not_a_month;           // [0:11] January is 0
+    vector<Day> day = vector<Day>(32); // [1:31] Waste day[0] for simplicity
+};
+
+struct Year {
+    int year;
+    vector<Month> month = vector<Month>(12);
+};
+
+struct Reading {
+    int day;
+    int hour;
+    double temperature;
+};
+
+void error(string s, int i = 0) { throw runtime_error(s + (i ? to_string(i) : "")); }
+
+vector<string> month_input_tbl = {
+    "jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec"
+};
+
+int month_to_int(string_view s) {
+    for (int i = 0; i < 12; ++i)
+        if (month_input_tbl[i] == s) return i;
+    return -1;
+}
+
+bool is_valid(const Reading& r) {
+    if (r.day < 1 || 31 < r.day) return false;
+    if (r.hour < 0 || 23 < r.hour) return false;
+    if (r.temperature < -200 || 200 < r.temperature) return false;
+    return true;
+}
+
+bool is_space(char c) { return c == ' ' || ('\t' <= c && c <= '\r'); }
+
+//--- 9.13.2: The 9.12 Scanner, Over Text in Memory ---
+
+// With all of the text in memory, a token never needs more() (see 9.12)
+class Scanner {
+    const char* p;
+    const char* e;
+
+public:
+    explicit Scanner(string_view s) : p{s.data()}, e{s.data() + s.size()} { }
+
+    int peek() {
+        while (p < e && is_space(*p)) ++p;
+        return p < e ? static_cast<unsigned char>(*p) : EOF;
+    }
+
+    bool accept(char c) {
+        if (peek() != static_cast<unsigned char>(c)) return false;
+        ++p;
+        return true;
+    }
+
+    string_view word() {
+        peek();
+        const char* q = p;
+        while (q < e && !is_space(*q)) ++q;
+        string_view w{p, size_t(q - p)};
+        p = q;
+        return w;
+    }
+
+    template<typename Number>
+    bool number(Number& x) {
+        peek();
+        auto [q, ec] = from_chars(p, e, x);
+        if (ec != errc{}) return false;
+        p = q;
+        return true;
+    }
+};
+
+bool scan(Scanner& s, Reading& r) {
+    if (!s.accept('(')) return false;
+    if (!(s.number(r.day) && s.number(r.hour) && s.number(r.temperature) && s.accept(')')))
+        error("bad reading");
+    return true;
+}
+
+// As in 9.12, but errors say which month they are in
+bool scan(Scanner& s, Month& m) {
+    if (!s.accept('{')) return false;
+    if (s.word() != "month") error("bad start of month");
+    string mm{s.word()};
+    m.month = month_to_int(mm);
+    if (m.month == not_a_month) error("bad month name '" + mm + "'");
+
+    try {
+        int duplicates = 0, invalids = 0;
+        for (Reading r; scan(s, r); ) {
+            if (is_valid(r)) {
+                if (m.day[r.day].temp[r.hour] != not_a_reading) ++duplicates;
+                m.day[r.day].temp[r.hour] = r.temperature;
+            } else ++invalids;
+        }
+        if (invalids) error("invalid readings in month", invalids);
+        if (duplicates) error("duplicate readings in month", duplicates);
+
+        if (!s.accept('}')) error("bad end of month");
+    } catch (runtime_error& e) {
+        error("month " + mm + ": " + e.what());
+    }
+    return true;
+}
+
+// As in 9.12, but errors say which year they are in
+bool scan(Scanner& s, Year& y) {
+    if (!s.accept('{')) return false;
+    if (s.word() != "year" || !s.number(y.year)) error("bad start of year");
+
+    try {
+        while (true) {
+            Month m;
+            if (!scan(s, m)) break;
+            y.month[m.month] = move(m);
+        }
+
+        if (!s.accept('}')) error("bad end of year");
+    } catch (runtime_error& e) {
+        error("year " + to_string(y.year) + ", " + e.what());
+    }
+    return true;
+}
+
+// The sequential loader, for comparison: one Scanner over the whole text
+vector<Year> scan_years(string_view text) {
+    Scanner s{text};
+    vector<Year> ys;
+    while (true) {
+        Year y;
+        if (!scan(s, y)) break;
+        ys.push_back(move(y));
+    }
+    return ys;
+}
+
+//--- 9.13.3: Running Tasks on a Few Threads ---
+
+// Call f(i) for every i in [0:n), on nthreads threads (this one included).
+// Tasks are taken from a shared counter, so a slow one doesn't hold up the rest
+template<typename F>
+void parallel_for(int n, int nthreads, F f) {
+    atomic<int> next_task{0};
+    auto worker = [&] {
+        for (int i; (i = next_task++) < n; ) f(i);
+    };
+    vector<thread> pool;
+    for (int t = 1; t < min(nthreads, n); ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+}
+
+//--- 9.13.4: Finding the Year Boundaries by Brace Depth ---
+
+struct Block {
+    size_t begin, end;   // "{ year ... }" is text[begin:end)
+};
+
+const size_t min_share = 1 << 20;   // Fewer bytes per thread aren't worth a thread
+
+vector<Block> split_years(string_view text, int nthreads) {
+    int nshares = int(clamp<size_t>(text.size() / min_share, 1, 4 * nthreads));
+    vector<size_t> cut(nshares + 1);
+    for (int i = 0; i <= nshares; ++i) cut[i] = text.size() * i / nshares;
+
+    // 1. The net change in depth over each share: count() is a loop the compiler vectorizes
+    vector<long> depth(nshares + 1, 0);
+    parallel_for(nshares, nthreads, [&](int i) {
+        auto first = text.begin() + cut[i], last = text.begin() + cut[i + 1];
+        depth[i + 1] = count(first, last, '{') - count(first, last, '}');
+    });
+    for (int i = 0; i < nshares; ++i) depth[i + 1] += depth[i];   // Depth where share i starts
+
+    // 2. Each share, knowing its starting depth, finds where years open and close,
+    //    and the first character at depth 0 that doesn't start a year. Inside
+    //    a year only braces matter, so memchr() jumps from one to the next
+    struct Found {
+        vector<size_t> opens, closes;
+        size_t stray = string_view::npos;
+    };
+    vector<Found> found(nshares);
+    parallel_for(nshares, nthreads, [&](int i) {
+        Found& f = found[i];
+        const size_t end = cut[i + 1];
+        auto next = [&](char c, size_t from) {
+            auto q = static_cast<const char*>(memchr(text.data() + from, c, end - from));
+            return q ? size_t(q - text.data()) : end;
+        };
+        long d = depth[i];
+        size_t k = cut[i];
+        size_t open = next('{', k), close = next('}', k);
+        while (k < end) {
+            if (d != 0) {
+                k = min(open, close);
+                if (k == end) break;
+            }
+            char c = text[k];
+            if (c == '{') {
+                if (d++ == 0) f.opens.push_back(k);
+                open = next('{', k + 1);
+            } else if (c == '}') {
+                if (d == 0) { f.stray = k; break; }
+                if (--d == 0) f.closes.push_back(k + 1);
+                close = next('}', k + 1);
+            } else if (!is_space(c)) {   // At depth 0, between years
+                f.stray = k;
+                break;
+            }
+            ++k;
+        }
+    });
+
+    // 3. Put them together; the data ends at the first stray character
+    vector<size_t> opens, closes;
+    for (const Found& f : found) {
+        opens.insert(opens.end(), f.opens.begin(), f.opens.end());
+        closes.insert(closes.end(), f.closes.begin(), f.closes.end());
+        if (f.stray != string_view::npos) break;
+    }
+    vector<Block> blocks;
+    for (size_t i = 0; i < opens.size(); ++i)   // An unclosed last year runs to the end
+        blocks.push_back(Block{opens[i], i < closes.size() ? closes[i] : text.size()});
+    return blocks;
+}
+
+//--- 9.13.5: The Parallel Loader ---
+
+vector<Year> parallel_scan_years(string_view text, int nthreads = thread::hardware_concurrency()) {
+    nthreads = max(1, nthreads);
+    vector<Block> blocks = split_years(text, nthreads);
+
+    // Batches of consecutive years, several per thread, so the work evens out
+    size_t target = max<size_t>(text.size() / (8 * nthreads), 1 << 18);
+    vector<size_t> bound{0};
+    size_t acc = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        acc += blocks[i].end - blocks[i].begin;
+        if (acc >= target) { bound.push_back(i + 1); acc = 0; }
+    }
+    if (bound.back() != blocks.size()) bound.push_back(blocks.size());
+
+    int nbatches = int(bound.size()) - 1;
+    vector<vector<Year>> years(nbatches);
+    vector<exception_ptr> errors(nbatches);
+    atomic<int> first_bad{nbatches};   // No point parsing batches after a bad one
+    parallel_for(nbatches, nthreads, [&](int b) {
+        if (b > first_bad) return;
+        try {
+            for (size_t i = bound[b]; i < bound[b + 1]; ++i) {
+                // The Scanner may see past the block's end, so that a bad year
+                // gets exactly the error the sequential loader would report
+                Scanner s{text.substr(blocks[i].begin)};
+                Year y;
+                scan(s, y);   // Starts with '{', so it is a year or an error
+                years[b].push_back(move(y));
+            }
+        } catch (...) {
+            errors[b] = current_exception();
+            for (int f = first_bad; b < f && !first_bad.compare_exchange_weak(f, b); ) { }
+        }
+    });
+
+    // Reassemble in file order; the first error in the file wins
+    vector<Year> ys;
+    ys.reserve(blocks.size());
+    for (int b = 0; b < nbatches; ++b) {
+        if (errors[b]) rethrow_exception(errors[b]);
+        move(years[b].begin(), years[b].end(), back_inserter(ys));
+    }
+    return ys;
+}
+
+vector<Year> load_years(const string& path, int nthreads = thread::hardware_concurrency()) {
+    ifstream ifs{path, ios::binary};
+    if (!ifs) error("can't open input file");
+    string text(filesystem::file_size(path), '\0');
+    if (!ifs.read(text.data(), text.size())) error("can't read input file");
+    return parallel_scan_years(text, nthreads);
+}
+
+//--- 9.13.6: Benchmark: Sequential vs Parallel ---
+
+bool same(const vector<Year>& a, const vector<Year>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].year != b[i].year) return false;
+        for (int m = 0; m < 12; ++m) {
+            if (a[i].month[m].month != b[i].month[m].month) return false;
+            for (int d = 0; d < 32; ++d)
+                if (a[i].month[m].day[d].temp != b[i].month[m].day[d].temp) return false;
+        }
+    }
+    return true;
+}
+
+// The 9.12 test file: about 100KB per year
+void write_test_file(const string& path, int years) {
+    ofstream ofs{path};
+    mt19937 rng{1990};
+    vector<pair<int, int>> slots;
+    for (int d = 1; d <= 31; ++d)
+        for (int h = 0; h < 24; ++h) slots.push_back({d, h});
+    for (int y = 0; y < years; ++y) {
+        ofs << "{ year " << 1800 + y << "\n";
+        for (int m = 0; m < 12; ++m) {
+            ofs << "  { month " << month_input_tbl[m] << "\n   ";
+            shuffle(slots.begin(), slots.end(), rng);
+            for (auto [d, h] : slots)
+                ofs << " (" << d << ' ' << h << ' ' << int(rng() % 1200) / 10.0 - 40 << ')';
+            ofs << "\n  }\n";
+        }
+        ofs << "}\n";
+    }
+}
+
+void benchmark() {
+    string path = (filesystem::temp_directory_path() / "ch9_13_temps.txt").string();
+    write_test_file(path, 400);
+    ifstream ifs{path, ios::binary};
+    string text{istreambuf_iterator<char>{ifs}, istreambuf_iterator<char>{}};
+    filesystem::remove(path);
+    double mb = text.size() / 1e6;
+
+    auto t0 = steady_clock::now();
+    vector<Year> seq = scan_years(text);
+    auto t1 = steady_clock::now();
+    cout << mb << "MB, " << seq.size() << " years\n";
+    cout << "sequential:  " << mb / duration<double>(t1 - t0).count() << " MB/s\n";
+
+    int hw = max(1u, thread::hardware_concurrency());
+    for (int t = 1; ; t = min(2 * t, hw)) {
+        auto t2 = steady_clock::now();
+        size_t nblocks = split_years(text, t).size();
+        auto t3 = steady_clock::now();
+        vector<Year> par = parallel_scan_years(text, t);
+        auto t4 = steady_clock::now();
+        cout << t << " thread" << (t > 1 ? "s: " : ":  ") << mb / duration<double>(t4 - t3).count()
+             << " MB/s (splitting into " << nblocks << " years alone: "
+             << mb / duration<double>(t3 - t2).count() << " MB/s); same data: " << same(seq, par) << "\n";
+        if (t == hw) break;
+    }
+}
+
+int main() {
+    string text =
+        "{ year 1990 { month jan (1 0 -4.5) } }\n"
+        "{ year 1991 { month feb (1 1 68) (2 3 66.66) } { month mar (4 5 12) (4 5 13) } }\n"
+        "{ year 1992 { month dec (15 15 -9.2) (15 14 -8.8) } }\n";
+    try {
+        parallel_scan_years(text, 2);
+    } catch (exception& e) {
+        cerr << "Error: " << e.what() << endl;
+    }
+
+    text.replace(text.find("(4 5 13)"), 8, "(4 6 13)");
+    vector<Year> ys = parallel_scan_years(text, 2);
+    cout << "Read " << ys.size() << " years of data:";
+    for (const Year& y : ys) cout << ' ' << y.year;
+    cout << "\n";
+
+    benchmark();
+    return 0;
+}